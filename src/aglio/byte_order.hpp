@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSSE3__)
+    #include <tmmintrin.h>
+#endif
+
+namespace aglio::detail {
+
+// Object representation of v with the bytes in Order, types that are not arithmetic or enums
+// are copied as they are
+template<std::endian Order,
+         typename T>
+constexpr std::array<std::byte, sizeof(T)> to_bytes(T const& v) {
+    auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(v);
+    if constexpr(Order != std::endian::native && (std::is_arithmetic_v<T> || std::is_enum_v<T>)) {
+        std::ranges::reverse(bytes);
+    }
+    return bytes;
+}
+
+template<std::endian Order,
+         typename T>
+constexpr T from_bytes(std::array<std::byte, sizeof(T)> bytes) {
+    if constexpr(Order != std::endian::native && (std::is_arithmetic_v<T> || std::is_enum_v<T>)) {
+        std::ranges::reverse(bytes);
+    }
+    return std::bit_cast<T>(bytes);
+}
+
+template<std::endian Order,
+         typename T>
+constexpr T from_bytes(std::span<std::byte const> bytes) {
+    std::array<std::byte, sizeof(T)> array{};
+    std::ranges::copy(bytes.first(sizeof(T)), array.begin());
+    return from_bytes<Order, T>(array);
+}
+
+// Reverses the bytes of every Size byte element of data in place. Whole registers are
+// shuffled at a time with AVX2 or SSSE3, the rest element by element.
+template<std::size_t Size>
+inline void byteswap_elements(std::span<std::byte> data) {
+    static_assert(Size == 2 || Size == 4 || Size == 8 || Size == 16, "unsupported element size");
+    std::size_t pos{};
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    constexpr auto mask = [] {
+        std::array<char, 16> m{};
+        for(std::size_t i = 0; i != m.size(); ++i) {
+            m[i] = static_cast<char>((i / Size) * Size + (Size - 1 - i % Size));
+        }
+        return m;
+    }();
+    #if defined(__AVX2__)
+    __m256i const shuffle256 = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<__m128i const*>(mask.data())));
+    for(; data.size() - pos >= 32; pos += 32) {
+        auto* p = reinterpret_cast<__m256i*>(data.subspan(pos).data());
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), shuffle256));
+    }
+    #endif
+    __m128i const shuffle128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mask.data()));
+    for(; data.size() - pos >= 16; pos += 16) {
+        auto* p = reinterpret_cast<__m128i*>(data.subspan(pos).data());
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), shuffle128));
+    }
+#endif
+
+    for(; data.size() - pos >= Size; pos += Size) {
+        std::ranges::reverse(data.subspan(pos, Size));
+    }
+}
+
+}   // namespace aglio::detail
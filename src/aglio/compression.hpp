@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace aglio {
+
+namespace detail {
+
+    inline constexpr std::size_t lz_min_match  = 4;
+    inline constexpr std::size_t lz_max_offset = 0xFFFF;
+    inline constexpr int         lz_hash_bits  = 12;
+
+    inline std::uint32_t lz_load32(std::byte const* p) {
+        std::uint32_t v{};
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline std::size_t lz_hash(std::uint32_t v,
+                               int           bits) {
+        return (v * 2'654'435'761U) >> (32 - bits);
+    }
+
+    // 15 in a nibble continues the length in bytes that are added up until one is not 255
+    inline std::byte* lz_put_length(std::byte*  out,
+                                    std::size_t length) {
+        for(; length >= 255; length -= 255) { *out++ = std::byte{255}; }
+        *out++ = static_cast<std::byte>(length);
+        return out;
+    }
+
+    inline bool lz_get_length(std::span<std::byte const>& in,
+                              std::size_t&                length) {
+        while(true) {
+            if(in.empty()) { return false; }
+            auto const byte = std::to_integer<std::size_t>(in.front());
+            in              = in.subspan(1);
+            length += byte;
+            if(byte != 255) { return true; }
+        }
+    }
+
+    inline std::byte* lz_put_sequence(std::byte*                 out,
+                                      std::span<std::byte const> literals,
+                                      std::size_t                offset,
+                                      std::size_t                match) {
+        auto const literal_nibble = std::min<std::size_t>(literals.size(), 15);
+        auto const match_nibble
+          = match == 0 ? std::size_t{} : std::min<std::size_t>(match - lz_min_match, 15);
+        *out++ = static_cast<std::byte>((literal_nibble << 4) | match_nibble);
+        if(literal_nibble == 15) { out = lz_put_length(out, literals.size() - 15); }
+        if(!literals.empty()) {
+            std::memcpy(out, literals.data(), literals.size());
+            out += literals.size();
+        }
+        if(match == 0) { return out; }
+        *out++ = static_cast<std::byte>(offset & 0xFF);
+        *out++ = static_cast<std::byte>(offset >> 8);
+        if(match_nibble == 15) { out = lz_put_length(out, match - lz_min_match - 15); }
+        return out;
+    }
+}   // namespace detail
+
+// LZ4 style block compression with zero runs. A block is a list of sequences: a token with the
+// literal length in its high and the match length minus 4 in its low nibble, the literals, a
+// two byte little endian offset and the match. Offset 0 is a run of zero bytes, the last
+// sequence ends after its literals.
+struct LzRle {
+    // Largest compressed size of size bytes
+    static constexpr std::size_t bound(std::size_t size) { return size + size / 255 + 16; }
+
+    // out needs bound(in.size()) bytes, returns the compressed size
+    static std::size_t compress(std::span<std::byte const> in,
+                                std::span<std::byte>       out) {
+        // small inputs only clear as much of the table as they can use
+        auto const bits = std::clamp(static_cast<int>(std::bit_width(in.size())),
+                                     8,
+                                     detail::lz_hash_bits);
+        std::array<std::uint32_t, std::size_t{1} << detail::lz_hash_bits> table;
+        std::fill_n(table.begin(), std::size_t{1} << bits, std::uint32_t{});
+
+        auto const* const begin  = in.data();
+        auto const        size   = in.size();
+        auto*             dst    = out.data();
+        std::size_t       anchor = 0;
+        std::size_t       pos    = 0;
+
+        auto const emit = [&](std::size_t offset,
+                              std::size_t match) {
+            dst    = detail::lz_put_sequence(dst, in.subspan(anchor, pos - anchor), offset, match);
+            pos    += match;
+            anchor = pos;
+        };
+
+        while(pos + detail::lz_min_match <= size) {
+            if(begin[pos] == std::byte{0}) {
+                auto const end = std::find_if(begin + pos, begin + size, [](std::byte b) {
+                    return b != std::byte{0};
+                });
+                auto const run = static_cast<std::size_t>(end - (begin + pos));
+                if(run >= detail::lz_min_match) {
+                    emit(0, run);
+                    continue;
+                }
+            }
+
+            auto const value     = detail::lz_load32(begin + pos);
+            auto&      slot      = table[detail::lz_hash(value, bits)];
+            auto const candidate = static_cast<std::size_t>(slot);
+            slot                 = static_cast<std::uint32_t>(pos);
+
+            // whatever the slot holds is only used when its bytes match
+            if(candidate < pos && pos - candidate <= detail::lz_max_offset
+               && detail::lz_load32(begin + candidate) == value)
+            {
+                auto match = detail::lz_min_match;
+                while(pos + match < size && begin[candidate + match] == begin[pos + match]) {
+                    ++match;
+                }
+                emit(pos - candidate, match);
+                continue;
+            }
+
+            // steps grow on data that does not compress
+            pos += 1 + ((pos - anchor) >> 6);
+        }
+
+        dst = detail::lz_put_sequence(dst, in.subspan(anchor), 0, 0);
+        return static_cast<std::size_t>(dst - out.data());
+    }
+
+    // out has to have exactly the uncompressed size, false when in is malformed or does not
+    // fill it
+    static bool decompress(std::span<std::byte const> in,
+                           std::span<std::byte>       out) {
+        std::size_t produced{};
+        while(true) {
+            if(in.empty()) { return false; }
+            auto const token = std::to_integer<std::size_t>(in.front());
+            in               = in.subspan(1);
+
+            std::size_t literals = token >> 4;
+            if(literals == 15 && !detail::lz_get_length(in, literals)) { return false; }
+            if(literals > in.size() || literals > out.size() - produced) { return false; }
+            if(literals != 0) {
+                std::memcpy(out.data() + produced, in.data(), literals);
+                produced += literals;
+                in = in.subspan(literals);
+            }
+
+            if(in.empty()) { return produced == out.size() && (token & 0x0F) == 0; }
+
+            if(in.size() < 2) { return false; }
+            auto const offset = std::to_integer<std::size_t>(in[0])
+                              | (std::to_integer<std::size_t>(in[1]) << 8);
+            in = in.subspan(2);
+
+            std::size_t match = token & 0x0F;
+            if(match == 15 && !detail::lz_get_length(in, match)) { return false; }
+            match += detail::lz_min_match;
+            if(match > out.size() - produced || offset > produced) { return false; }
+
+            auto* const dst = out.data() + produced;
+            if(offset == 0) {
+                std::memset(dst, 0, match);
+            } else if(offset >= match) {
+                std::memcpy(dst, dst - offset, match);
+            } else {
+                // overlapping matches repeat the last offset bytes
+                for(std::size_t i = 0; i != match; ++i) { dst[i] = *(dst + i - offset); }
+            }
+            produced += match;
+        }
+    }
+};
+
+}   // namespace aglio
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define AGLIO_CRC_X86_DISPATCH
+    #include <immintrin.h>
+#endif
+
+namespace aglio {
+namespace detail {
+
+    template<typename T, T Poly, bool Reflected>
+    struct crc_tables {
+        static constexpr std::array<std::array<T, 256>, 8> tables = [] {
+            constexpr auto Bits = std::numeric_limits<T>::digits;
+
+            std::array<std::array<T, 256>, 8> t{};
+            for(std::size_t i = 0; i != 256; ++i) {
+                T crc{};
+                if constexpr(Reflected) {
+                    crc = static_cast<T>(i);
+                    for(int bit = 0; bit != 8; ++bit) {
+                        crc = static_cast<T>((crc & 1U) != 0 ? (crc >> 1) ^ Poly : crc >> 1);
+                    }
+                } else {
+                    crc = static_cast<T>(i << (Bits - 8));
+                    for(int bit = 0; bit != 8; ++bit) {
+                        crc = static_cast<T>((crc >> (Bits - 1)) != 0 ? (crc << 1) ^ Poly
+                                                                      : crc << 1);
+                    }
+                }
+                t[0][i] = crc;
+            }
+            for(std::size_t k = 1; k != 8; ++k) {
+                for(std::size_t i = 0; i != 256; ++i) {
+                    auto const prev = t[k - 1][i];
+                    if constexpr(Reflected) {
+                        t[k][i] = static_cast<T>((prev >> 8) ^ t[0][prev & 0xFFU]);
+                    } else {
+                        t[k][i] = static_cast<T>(static_cast<T>(prev << 8)
+                                                 ^ t[0][(prev >> (Bits - 8)) & 0xFFU]);
+                    }
+                }
+            }
+            return t;
+        }();
+
+        // Slicing-by-8, crc is the raw register without init/xorout applied
+        static constexpr T update(T                          crc,
+                                  std::span<std::byte const> data) {
+            constexpr auto Bits = std::numeric_limits<T>::digits;
+            auto const&    t    = tables;
+
+            auto byte = [&](std::size_t i) { return std::to_integer<std::size_t>(data[i]); };
+
+            std::size_t pos{};
+            for(; data.size() - pos >= 8; pos += 8) {
+                if constexpr(Reflected) {
+                    std::array<std::size_t, 8> b{};
+                    for(std::size_t i = 0; i != 8; ++i) {
+                        b[i] = byte(pos + i)
+                             ^ (i < sizeof(T) ? static_cast<std::size_t>((crc >> (8 * i)) & 0xFFU)
+                                              : 0);
+                    }
+                    crc = static_cast<T>(t[7][b[0]] ^ t[6][b[1]] ^ t[5][b[2]] ^ t[4][b[3]]
+                                         ^ t[3][b[4]] ^ t[2][b[5]] ^ t[1][b[6]] ^ t[0][b[7]]);
+                } else {
+                    std::array<std::size_t, 8> b{};
+                    for(std::size_t i = 0; i != 8; ++i) {
+                        b[i] = byte(pos + i)
+                             ^ (i < sizeof(T)
+                                  ? static_cast<std::size_t>((crc >> (Bits - 8 * (i + 1))) & 0xFFU)
+                                  : 0);
+                    }
+                    crc = static_cast<T>(t[7][b[0]] ^ t[6][b[1]] ^ t[5][b[2]] ^ t[4][b[3]]
+                                         ^ t[3][b[4]] ^ t[2][b[5]] ^ t[1][b[6]] ^ t[0][b[7]]);
+                }
+            }
+            for(; pos != data.size(); ++pos) {
+                if constexpr(Reflected) {
+                    crc = static_cast<T>((crc >> 8) ^ t[0][(crc ^ byte(pos)) & 0xFFU]);
+                } else {
+                    crc = static_cast<T>(static_cast<T>(crc << 8)
+                                         ^ t[0][((crc >> (Bits - 8)) ^ byte(pos)) & 0xFFU]);
+                }
+            }
+            return crc;
+        }
+    };
+
+#if defined(AGLIO_CRC_X86_DISPATCH)
+    __attribute__((target("sse4.2"))) inline std::uint32_t
+    crc32c_update_sse42(std::uint32_t              crc,
+                        std::span<std::byte const> data) {
+        auto const* p    = data.data();
+        auto        size = data.size();
+
+        std::uint64_t crc64 = crc;
+        for(; size >= 8; size -= 8, p += 8) {
+            std::uint64_t word{};
+            __builtin_memcpy(&word, p, sizeof(word));
+            crc64 = _mm_crc32_u64(crc64, word);
+        }
+        crc = static_cast<std::uint32_t>(crc64);
+        for(; size != 0; --size, ++p) {
+            crc = _mm_crc32_u8(crc, std::to_integer<std::uint8_t>(*p));
+        }
+        return crc;
+    }
+
+    __attribute__((target("pclmul,sse4.1"))) inline __m128i crc32_fold(__m128i x,
+                                                                       __m128i k,
+                                                                       __m128i next) {
+        __m128i const lo = _mm_clmulepi64_si128(x, k, 0x00);
+        __m128i const hi = _mm_clmulepi64_si128(x, k, 0x11);
+        return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+    }
+
+    // Folding with carry-less multiplication, constants from Intel's "Fast CRC Computation for
+    // Generic Polynomials Using PCLMULQDQ Instruction". Needs data.size() >= 64 and a
+    // multiple of 16.
+    __attribute__((target("pclmul,sse4.1"))) inline std::uint32_t
+    crc32_update_pclmul(std::uint32_t              crc,
+                        std::span<std::byte const> data) {
+        alignas(16) static constexpr std::uint64_t k1k2[]{0x0154442bd4, 0x01c6e41596};
+        alignas(16) static constexpr std::uint64_t k3k4[]{0x01751997d0, 0x00ccaa009e};
+        alignas(16) static constexpr std::uint64_t k5k0[]{0x0163cd6124, 0x0000000000};
+        alignas(16) static constexpr std::uint64_t poly[]{0x01db710641, 0x01f7011641};
+
+        auto const* buf  = reinterpret_cast<__m128i const*>(data.data());
+        auto        size = data.size();
+
+        __m128i x1 = _mm_loadu_si128(buf + 0);
+        __m128i x2 = _mm_loadu_si128(buf + 1);
+        __m128i x3 = _mm_loadu_si128(buf + 2);
+        __m128i x4 = _mm_loadu_si128(buf + 3);
+        x1         = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+        __m128i x0 = _mm_load_si128(reinterpret_cast<__m128i const*>(k1k2));
+        buf += 4;
+        size -= 64;
+
+        for(; size >= 64; size -= 64, buf += 4) {
+            x1 = crc32_fold(x1, x0, _mm_loadu_si128(buf + 0));
+            x2 = crc32_fold(x2, x0, _mm_loadu_si128(buf + 1));
+            x3 = crc32_fold(x3, x0, _mm_loadu_si128(buf + 2));
+            x4 = crc32_fold(x4, x0, _mm_loadu_si128(buf + 3));
+        }
+
+        x0 = _mm_load_si128(reinterpret_cast<__m128i const*>(k3k4));
+        x1 = crc32_fold(x1, x0, x2);
+        x1 = crc32_fold(x1, x0, x3);
+        x1 = crc32_fold(x1, x0, x4);
+
+        for(; size >= 16; size -= 16, ++buf) { x1 = crc32_fold(x1, x0, _mm_loadu_si128(buf)); }
+
+        __m128i const mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+        x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+        x0 = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(k5k0));
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        x0 = _mm_load_si128(reinterpret_cast<__m128i const*>(poly));
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), x0, 0x10);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        return static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1));
+    }
+#endif
+
+    using crc16_ccitt_tables = crc_tables<std::uint16_t, 0x1021, false>;
+    using crc32_tables       = crc_tables<std::uint32_t, 0xEDB8'8320, true>;
+    using crc32c_tables      = crc_tables<std::uint32_t, 0x82F6'3B78, true>;
+
+    inline std::uint32_t crc32_update(std::uint32_t              crc,
+                                      std::span<std::byte const> data) {
+#if defined(AGLIO_CRC_X86_DISPATCH)
+        static bool const has_pclmul
+          = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+        if(has_pclmul && data.size() >= 64) {
+            auto const folded = data.size() & ~std::size_t{15};
+            crc               = crc32_update_pclmul(crc, data.first(folded));
+            data              = data.subspan(folded);
+        }
+#endif
+        return crc32_tables::update(crc, data);
+    }
+
+    inline std::uint32_t crc32c_update(std::uint32_t              crc,
+                                       std::span<std::byte const> data) {
+#if defined(AGLIO_CRC_X86_DISPATCH)
+        static bool const has_sse42 = __builtin_cpu_supports("sse4.2");
+        if(has_sse42) { return crc32c_update_sse42(crc, data); }
+#endif
+        return crc32c_tables::update(crc, data);
+    }
+
+    // Crc policies that can be fed piecewise, calc(data) == finalize(update(init(), data))
+    template<typename Crc>
+    concept incremental_crc = requires(typename Crc::type crc, std::span<std::byte const> data) {
+        { Crc::init() } -> std::same_as<typename Crc::type>;
+        { Crc::update(crc, data) } -> std::same_as<typename Crc::type>;
+        { Crc::finalize(crc) } -> std::same_as<typename Crc::type>;
+    };
+
+}   // namespace detail
+
+// CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, not reflected
+struct Crc16Ccitt {
+    using type = std::uint16_t;
+
+    static constexpr type init() { return 0xFFFF; }
+
+    static constexpr type update(type                       crc,
+                                 std::span<std::byte const> data) {
+        return detail::crc16_ccitt_tables::update(crc, data);
+    }
+
+    static constexpr type finalize(type crc) { return crc; }
+
+    static constexpr type calc(std::span<std::byte const> data) {
+        return finalize(update(init(), data));
+    }
+};
+
+// CRC-32 (IEEE 802.3, zlib): poly 0x04C11DB7 reflected, init and xorout 0xFFFFFFFF
+struct Crc32 {
+    using type = std::uint32_t;
+
+    static constexpr type init() { return 0xFFFF'FFFF; }
+
+    static constexpr type update(type                       crc,
+                                 std::span<std::byte const> data) {
+        if(std::is_constant_evaluated()) { return detail::crc32_tables::update(crc, data); }
+        return detail::crc32_update(crc, data);
+    }
+
+    static constexpr type finalize(type crc) { return ~crc; }
+
+    static constexpr type calc(std::span<std::byte const> data) {
+        return finalize(update(init(), data));
+    }
+};
+
+// CRC-32C (Castagnoli, iSCSI): poly 0x1EDC6F41 reflected, init and xorout 0xFFFFFFFF
+struct Crc32c {
+    using type = std::uint32_t;
+
+    static constexpr type init() { return 0xFFFF'FFFF; }
+
+    static constexpr type update(type                       crc,
+                                 std::span<std::byte const> data) {
+        if(std::is_constant_evaluated()) { return detail::crc32c_tables::update(crc, data); }
+        return detail::crc32c_update(crc, data);
+    }
+
+    static constexpr type finalize(type crc) { return ~crc; }
+
+    static constexpr type calc(std::span<std::byte const> data) {
+        return finalize(update(init(), data));
+    }
+};
+
+}   // namespace aglio
+
+#undef AGLIO_CRC_X86_DISPATCH
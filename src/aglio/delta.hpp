@@ -0,0 +1,185 @@
+#pragma once
+
+#include "serializer.hpp"
+#include "type_descriptor.hpp"
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace aglio {
+
+namespace detail {
+    enum class DeltaKind : std::uint8_t { Keyframe = 0, Delta = 1 };
+
+    // Members that cannot be compared count as changed, floating point compares bitwise so
+    // that -0.0 and NaN payloads are sent
+    template<typename T>
+    constexpr bool same_member(T const& a,
+                               T const& b) {
+        if constexpr(std::is_floating_point_v<T>) {
+            return std::bit_cast<std::array<std::byte, sizeof(T)>>(a)
+                == std::bit_cast<std::array<std::byte, sizeof(T)>>(b);
+        } else if constexpr(std::equality_comparable<T>) {
+            return a == b;
+        } else {
+            return false;
+        }
+    }
+
+    template<typename T>
+    inline constexpr std::size_t delta_mask_size = (glz::reflect<T>::size + 7) / 8;
+}   // namespace detail
+
+// Encodes successive values of T against the last one it encoded. Every message starts with
+// its kind and a sequence number. Keyframes carry the whole value, deltas a mask of the
+// changed members followed by those members. A keyframe is sent first, after
+// force_keyframe() and every keyframeInterval messages when that is not 0.
+template<Described T,
+         typename Size_t = std::uint16_t>
+struct DeltaSerializer {
+private:
+    std::optional<T> last_{};
+    std::uint32_t    sequence_{};
+    std::size_t      keyframeInterval_{};
+    std::size_t      sinceKeyframe_{};
+
+    template<typename Buffer>
+    bool serialize_delta(Buffer&  buffer,
+                         T const& v) {
+        auto const tie      = glz::to_tie(v);
+        auto const last_tie = glz::to_tie(*last_);
+        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            using std::get;
+            std::array<std::byte, detail::delta_mask_size<T>> mask{};
+            ((detail::same_member(get<Is>(tie), get<Is>(last_tie))
+                ? void()
+                : void(mask[Is / 8] |= std::byte{1} << (Is % 8))),
+             ...);
+            if(!buffer.insert(mask)) { return false; }
+            return ([&] {
+                if(((std::to_integer<unsigned>(mask[Is / 8]) >> (Is % 8)) & 1U) == 0) {
+                    return true;
+                }
+                return serializer<std::remove_cvref_t<decltype(get<Is>(tie))>, Size_t>::serialize(
+                  get<Is>(tie),
+                  buffer);
+            }() && ...);
+        }(std::make_index_sequence<glz::reflect<T>::size>{});
+    }
+
+public:
+    explicit DeltaSerializer(std::size_t keyframeInterval = 0)
+      : keyframeInterval_{keyframeInterval} {}
+
+    void force_keyframe() { last_.reset(); }
+
+    std::uint32_t next_sequence() const { return sequence_; }
+
+    // On failure nothing is remembered, the next message is encoded against the same state
+    template<typename Buffer>
+    bool serialize(Buffer&  buffer,
+                   T const& v) {
+        bool const keyframe
+          = !last_.has_value() || (keyframeInterval_ != 0 && sinceKeyframe_ >= keyframeInterval_);
+        auto const kind = keyframe ? detail::DeltaKind::Keyframe : detail::DeltaKind::Delta;
+
+        if(!serializer<detail::DeltaKind, Size_t>::serialize(kind, buffer)
+           || !serializer<std::uint32_t, Size_t>::serialize(sequence_, buffer))
+        {
+            return false;
+        }
+        if(keyframe) {
+            if(!serializer<T, Size_t>::serialize(v, buffer)) { return false; }
+            sinceKeyframe_ = 0;
+        } else {
+            if(!serialize_delta(buffer, v)) { return false; }
+        }
+
+        if(last_.has_value()) {
+            *last_ = v;
+        } else {
+            last_.emplace(v);
+        }
+        ++sequence_;
+        ++sinceKeyframe_;
+        return true;
+    }
+};
+
+// Applies the messages of a DeltaSerializer to its value in place. Deltas are only applied on
+// top of the message right before them, a missing or broken message leaves the deserializer
+// unsynced until the next keyframe.
+template<Described T,
+         typename Size_t = std::uint16_t>
+struct DeltaDeserializer {
+private:
+    T             value_{};
+    std::uint32_t sequence_{};
+    bool          synced_{};
+
+    template<typename Buffer>
+    bool deserialize_delta(Buffer& buffer) {
+        std::array<std::byte, detail::delta_mask_size<T>> mask{};
+        if(!buffer.extract(mask)) { return false; }
+        if constexpr(glz::reflect<T>::size % 8 != 0) {
+            if((std::to_integer<unsigned>(mask.back()) >> (glz::reflect<T>::size % 8)) != 0) {
+                return false;
+            }
+        }
+        auto tie = glz::to_tie(value_);
+        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            using std::get;
+            return ([&] {
+                if(((std::to_integer<unsigned>(mask[Is / 8]) >> (Is % 8)) & 1U) == 0) {
+                    return true;
+                }
+                return serializer<std::remove_cvref_t<decltype(get<Is>(tie))>,
+                                  Size_t>::deserialize(get<Is>(tie), buffer);
+            }() && ...);
+        }(std::make_index_sequence<glz::reflect<T>::size>{});
+    }
+
+public:
+    bool synced() const { return synced_; }
+
+    // Only meaningful while synced()
+    T const& value() const { return value_; }
+
+    std::uint32_t sequence() const { return sequence_; }
+
+    void reset() { synced_ = false; }
+
+    // false when the message could not be applied, synced() tells whether a keyframe is
+    // needed to continue
+    template<typename Buffer>
+    bool deserialize(Buffer& buffer) {
+        detail::DeltaKind kind{};
+        std::uint32_t     sequence{};
+        if(!serializer<detail::DeltaKind, Size_t>::deserialize(kind, buffer)
+           || !serializer<std::uint32_t, Size_t>::deserialize(sequence, buffer))
+        {
+            return false;
+        }
+
+        if(kind == detail::DeltaKind::Keyframe) {
+            synced_ = serializer<T, Size_t>::deserialize(value_, buffer);
+        } else if(kind == detail::DeltaKind::Delta && synced_
+                  && sequence == static_cast<std::uint32_t>(sequence_ + 1))
+        {
+            synced_ = deserialize_delta(buffer);
+        } else {
+            synced_ = false;
+        }
+
+        if(synced_) { sequence_ = sequence; }
+        return synced_;
+    }
+};
+
+}   // namespace aglio
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "packager.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace aglio {
+
+// Incremental frame decoder for byte streams that arrive in chunks. Headers are validated
+// once, already scanned bytes are never parsed again and the internal buffer is only moved
+// down when more than half of it has been consumed.
+template<typename Config>
+struct FrameDecoder {
+private:
+    using Frames = detail::FrameAccess<aglio::Packager<Config>>;
+
+    std::vector<std::byte>     buffer_{};
+    std::size_t                position_{};
+    std::optional<std::size_t> frameSize_{};
+
+    void compact() {
+        if(position_ == buffer_.size()) {
+            buffer_.clear();
+            position_ = 0;
+        } else if(position_ > buffer_.size() / 2) {
+            buffer_.erase(buffer_.begin(),
+                          std::next(buffer_.begin(),
+                                    static_cast<std::make_signed_t<std::size_t>>(position_)));
+            position_ = 0;
+        }
+    }
+
+public:
+    // Number of received bytes that do not belong to a decoded frame yet
+    std::size_t buffered() const { return buffer_.size() - position_; }
+
+    void reset() {
+        buffer_.clear();
+        position_ = 0;
+        frameSize_.reset();
+    }
+
+    // Appends data and calls callback(T&&) once for every frame that got complete.
+    // Returns the number of decoded frames.
+    template<typename T,
+             typename Callback>
+    std::size_t feed(std::span<std::byte const> data,
+                     Callback&&                 callback) {
+        buffer_.insert(buffer_.end(), data.begin(), data.end());
+
+        std::size_t decoded{};
+        while(true) {
+            auto const span = std::span<std::byte const>{buffer_}.subspan(position_);
+
+            if(!frameSize_) {
+                auto const header = Frames::check_header(span);
+                if(header.status == Frames::HeaderStatus::Incomplete) { break; }
+                if(header.status == Frames::HeaderStatus::Invalid) {
+                    position_ += Frames::resync_offset(span);
+                    continue;
+                }
+                frameSize_ = header.frameSize;
+            }
+
+            if(*frameSize_ > span.size()) { break; }
+
+            auto const frame = span.first(*frameSize_);
+            T          v{};
+            if(!Frames::check_body(frame) || !Frames::deserialize_body(frame, v)) {
+                frameSize_.reset();
+                position_ += Frames::resync_offset(span);
+                continue;
+            }
+
+            position_ += *frameSize_;
+            frameSize_.reset();
+            ++decoded;
+            std::invoke(callback, std::move(v));
+        }
+
+        compact();
+        return decoded;
+    }
+};
+
+}   // namespace aglio
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#if __has_include(<sys/uio.h>)
+    #include <sys/uio.h>
+#endif
+
+namespace aglio {
+
+// Serialization view that produces a list of segments instead of one contiguous buffer.
+// Small inserts are copied into an internal scratch buffer, large contiguous ranges passed to
+// insert_ref are referenced in place and must outlive every use of the segments.
+struct GatherBuffer {
+private:
+    // scratch pieces are stored as offsets because the scratch buffer may reallocate
+    struct Piece {
+        std::byte const* ref{};
+        std::size_t      offset{};
+        std::size_t      size{};
+    };
+
+    std::vector<std::byte> scratch_{};
+    std::vector<Piece>     pieces_{};
+    std::size_t            size_{};
+    std::size_t            refThreshold_{};
+
+    std::span<std::byte const> resolve(Piece const& piece) const {
+        if(piece.ref != nullptr) { return {piece.ref, piece.size}; }
+        return std::span<std::byte const>{scratch_}.subspan(piece.offset, piece.size);
+    }
+
+public:
+    explicit GatherBuffer(std::size_t refThreshold = 1024) : refThreshold_{refThreshold} {}
+
+    std::size_t size() const { return size_; }
+
+    std::size_t segment_count() const { return pieces_.size(); }
+
+    void clear() {
+        scratch_.clear();
+        pieces_.clear();
+        size_ = 0;
+    }
+
+    bool insert(std::span<std::byte const> data) {
+        if(data.empty()) { return true; }
+        auto const offset = scratch_.size();
+        scratch_.insert(scratch_.end(), data.begin(), data.end());
+        if(!pieces_.empty() && pieces_.back().ref == nullptr) {
+            pieces_.back().size += data.size();
+        } else {
+            pieces_.push_back({.ref = nullptr, .offset = offset, .size = data.size()});
+        }
+        size_ += data.size();
+        return true;
+    }
+
+    bool insert_ref(std::span<std::byte const> data) {
+        if(data.size() < refThreshold_) { return insert(data); }
+        pieces_.push_back({.ref = data.data(), .offset = 0, .size = data.size()});
+        size_ += data.size();
+        return true;
+    }
+
+    // Writable bytes [offset, offset + size) of the whole gathered output, they have to be
+    // inside a single piece that was copied into scratch. Searches from the back, patching
+    // happens close to the end.
+    std::span<std::byte> overwrite(std::size_t offset,
+                                   std::size_t size) {
+        std::size_t end = size_;
+        for(auto it = pieces_.rbegin(); it != pieces_.rend(); ++it) {
+            auto const begin = end - it->size;
+            if(offset >= begin) {
+                if(it->ref != nullptr || offset + size > end) { return {}; }
+                return std::span{scratch_}.subspan(it->offset + (offset - begin), size);
+            }
+            end = begin;
+        }
+        return {};
+    }
+
+    template<typename F>
+    void for_each_segment(F&& f) const {
+        for(auto const& piece : pieces_) { f(resolve(piece)); }
+    }
+
+    std::vector<std::span<std::byte const>> segments() const {
+        std::vector<std::span<std::byte const>> segments{};
+        segments.reserve(pieces_.size());
+        for_each_segment([&](std::span<std::byte const> segment) { segments.push_back(segment); });
+        return segments;
+    }
+
+#if __has_include(<sys/uio.h>)
+    // Ready for writev / sendmsg, valid until the next modification of this buffer
+    std::vector<::iovec> iovecs() const {
+        std::vector<::iovec> iov{};
+        iov.reserve(pieces_.size());
+        for_each_segment([&](std::span<std::byte const> segment) {
+            // iovec has no const member, the kernel only reads from it for writev
+            iov.push_back({.iov_base = const_cast<std::byte*>(segment.data()),
+                           .iov_len  = segment.size()});
+        });
+        return iov;
+    }
+#endif
+};
+
+}   // namespace aglio
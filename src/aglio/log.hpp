@@ -0,0 +1,619 @@
+#pragma once
+
+#include "packager.hpp"
+#include "serialization_buffers.hpp"
+#include "serializer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && __has_include(<fcntl.h>) \
+  && __has_include(<unistd.h>)
+    #define AGLIO_LOG_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace aglio {
+
+struct LogOptions {
+    // a new segment is started once the current one reached this size
+    std::size_t segmentSize{64 * 1024 * 1024};
+    // bytes of records between two entries of the sparse index
+    std::size_t indexInterval{4096};
+};
+
+namespace detail {
+
+    // Entry of the sparse index, stored as raw host order bytes in the .idx file
+    struct LogIndexEntry {
+        std::uint64_t sequence{};
+        std::uint64_t offset{};
+        std::int64_t  timestamp{};
+    };
+
+    inline LogIndexEntry log_index_entry(std::span<std::byte const> index,
+                                         std::size_t                i) {
+        LogIndexEntry entry{};
+        std::memcpy(std::addressof(entry),
+                    index.subspan(i * sizeof(LogIndexEntry), sizeof(LogIndexEntry)).data(),
+                    sizeof(LogIndexEntry));
+        return entry;
+    }
+
+    inline std::size_t log_index_size(std::span<std::byte const> index) {
+        return index.size() / sizeof(LogIndexEntry);
+    }
+
+    // Segments are named after the sequence number of their first record
+    inline std::filesystem::path log_segment_path(std::filesystem::path const& directory,
+                                                  std::uint64_t                firstSequence,
+                                                  char const*                  extension) {
+        auto name = std::to_string(firstSequence);
+        name.insert(0, 20 - name.size(), '0');
+        return directory / (name + extension);
+    }
+
+    inline std::vector<std::uint64_t> log_segments(std::filesystem::path const& directory) {
+        std::vector<std::uint64_t> segments{};
+        std::error_code            ec{};
+        for(auto const& entry : std::filesystem::directory_iterator{directory, ec}) {
+            auto const& path = entry.path();
+            if(path.extension() != ".log") { continue; }
+            auto const    stem = path.stem().string();
+            auto const*   last = stem.data() + stem.size();
+            std::uint64_t first{};
+            auto const [end, error] = std::from_chars(stem.data(), last, first);
+            if(stem.size() != 20 || error != std::errc{} || end != last) {
+                continue;
+            }
+            segments.push_back(first);
+        }
+        std::ranges::sort(segments);
+        return segments;
+    }
+
+    // Read-only view of a whole file, mmap'ed where available
+    struct MappedFile {
+    private:
+#if defined(AGLIO_LOG_MMAP)
+        void*       data_{};
+        std::size_t size_{};
+#else
+        std::vector<std::byte> data_{};
+#endif
+
+    public:
+        MappedFile() = default;
+
+        explicit MappedFile(std::filesystem::path const& path) {
+#if defined(AGLIO_LOG_MMAP)
+            int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd < 0) { return; }
+            struct ::stat st{};
+            if(::fstat(fd, std::addressof(st)) == 0 && st.st_size > 0) {
+                auto const size = static_cast<std::size_t>(st.st_size);
+                void*      p    = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                if(p != MAP_FAILED) {
+                    data_ = p;
+                    size_ = size;
+                }
+            }
+            ::close(fd);
+#else
+            std::error_code ec{};
+            auto const      size = std::filesystem::file_size(path, ec);
+            if(ec) { return; }
+            std::ifstream file{path, std::ios::binary};
+            data_.resize(static_cast<std::size_t>(size));
+            file.read(reinterpret_cast<char*>(data_.data()), static_cast<std::streamsize>(size));
+            data_.resize(static_cast<std::size_t>(file.gcount()));
+#endif
+        }
+
+        MappedFile(MappedFile const&)            = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept { swap(other); }
+
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            MappedFile tmp{std::move(other)};
+            swap(tmp);
+            return *this;
+        }
+
+        ~MappedFile() {
+#if defined(AGLIO_LOG_MMAP)
+            if(data_ != nullptr) { ::munmap(data_, size_); }
+#endif
+        }
+
+        void swap(MappedFile& other) noexcept {
+#if defined(AGLIO_LOG_MMAP)
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+#else
+            data_.swap(other.data_);
+#endif
+        }
+
+        std::span<std::byte const> bytes() const {
+#if defined(AGLIO_LOG_MMAP)
+            return {static_cast<std::byte const*>(data_), size_};
+#else
+            return data_;
+#endif
+        }
+    };
+
+    struct LogFrame {
+        std::size_t                size{};
+        std::int64_t               timestamp{};
+        std::span<std::byte const> payload{};
+    };
+
+    // Complete, intact record at the start of bytes. A frame is a regular Packager frame whose
+    // body is the timestamp followed by the serialized value.
+    template<typename Config>
+    std::optional<LogFrame> log_frame(std::span<std::byte const> bytes) {
+        using Frames = FrameAccess<aglio::Packager<Config>>;
+
+        auto const header = Frames::check_header(bytes);
+        if(header.status != Frames::HeaderStatus::Valid || header.frameSize > bytes.size()) {
+            return std::nullopt;
+        }
+        auto const frame = bytes.first(header.frameSize);
+        if(!Frames::check_body(frame)) { return std::nullopt; }
+
+        auto body = Frames::uncompressed_body(frame);
+        if(!body) { return std::nullopt; }
+
+        aglio::DynamicDeserializationView debuff{*body};
+        std::int64_t                      timestamp{};
+        if(!aglio::Serializer<typename Config::Size_t>::deserialize(debuff, timestamp)) {
+            return std::nullopt;
+        }
+        return LogFrame{.size      = header.frameSize,
+                        .timestamp = timestamp,
+                        .payload   = body->subspan(body->size() - debuff.available())};
+    }
+
+    // Whether the bytes that log_frame rejected are damaged rather than a frame that is not
+    // completely written yet
+    template<typename Config>
+    bool log_damaged(std::span<std::byte const> bytes) {
+        using Frames = FrameAccess<aglio::Packager<Config>>;
+
+        auto const header = Frames::check_header(bytes);
+        return header.status == Frames::HeaderStatus::Invalid
+            || (header.status == Frames::HeaderStatus::Valid && header.frameSize <= bytes.size());
+    }
+
+    // Offset of the next intact record after the damaged one at offset
+    template<typename Config>
+    std::optional<std::size_t> log_resync(std::span<std::byte const> bytes,
+                                          std::size_t                offset) {
+        using Frames = FrameAccess<aglio::Packager<Config>>;
+
+        while(offset < bytes.size()) {
+            offset += Frames::resync_offset(bytes.subspan(offset));
+            if(log_frame<Config>(bytes.subspan(offset))) { return offset; }
+        }
+        return std::nullopt;
+    }
+
+    // Sequence number of the intact record at offset after damaged bytes. The first index entry
+    // behind it or else the first sequence number of the next segment pins it down if the
+    // records in between are intact, otherwise the damage is taken for a single record.
+    template<typename Config>
+    std::uint64_t log_sequence_after_damage(std::span<std::byte const>   bytes,
+                                            std::span<std::byte const>   index,
+                                            std::size_t                  offset,
+                                            std::optional<std::uint64_t> nextSegment,
+                                            std::uint64_t                damagedSequence) {
+        auto const entries = std::views::iota(std::size_t{}, log_index_size(index));
+        auto const entry   = std::ranges::partition_point(entries, [&](std::size_t i) {
+            return log_index_entry(index, i).offset < offset;
+        });
+
+        std::optional<std::pair<std::size_t, std::uint64_t>> pin{};
+        if(entry != entries.end()) {
+            auto const pinned = log_index_entry(index, *entry);
+            pin = {static_cast<std::size_t>(pinned.offset), pinned.sequence};
+        } else if(nextSegment) {
+            pin = {bytes.size(), *nextSegment};
+        }
+
+        if(pin) {
+            std::uint64_t count{};
+            while(offset < pin->first) {
+                auto const frame = log_frame<Config>(bytes.subspan(offset));
+                if(!frame) { break; }
+                offset += frame->size;
+                ++count;
+            }
+            if(offset == pin->first && count < pin->second
+               && pin->second - count > damagedSequence)
+            {
+                return pin->second - count;
+            }
+        }
+        return damagedSequence + 1;
+    }
+
+}   // namespace detail
+
+// Appends Packager frames to segment files <first sequence>.log in a directory and writes a
+// sparse index <first sequence>.idx next to each of them. Reopening a directory continues
+// after the last intact record, a torn frame at the end is cut off. A last segment with damaged
+// records in front of intact ones is kept as it is and new records start a new segment.
+template<typename Config>
+struct LogWriter {
+private:
+    using Packager = aglio::Packager<Config>;
+
+    std::filesystem::path      directory_;
+    LogOptions                 options_;
+    std::ofstream              log_{};
+    std::ofstream              index_{};
+    std::vector<std::byte>     frame_{};
+    std::uint64_t              nextSequence_{};
+    std::size_t                segmentSize_{};
+    std::optional<std::size_t> lastIndexed_{};
+    std::error_code            error_{};
+
+    bool open_segment(std::uint64_t           firstSequence,
+                      std::ios_base::openmode mode) {
+        log_.close();
+        index_.close();
+        log_.open(detail::log_segment_path(directory_, firstSequence, ".log"),
+                  std::ios::binary | mode);
+        index_.open(detail::log_segment_path(directory_, firstSequence, ".idx"),
+                    std::ios::binary | mode);
+        return log_.is_open() && index_.is_open();
+    }
+
+    void recover(std::uint64_t firstSequence) {
+        auto const  logPath   = detail::log_segment_path(directory_, firstSequence, ".log");
+        auto const  indexPath = detail::log_segment_path(directory_, firstSequence, ".idx");
+        std::size_t validEnd{};
+        std::size_t indexEntries{};
+        bool        damaged{};
+        {
+            detail::MappedFile const log{logPath};
+            detail::MappedFile const index{indexPath};
+            auto const               bytes = log.bytes();
+
+            nextSequence_ = firstSequence;
+            for(auto i = detail::log_index_size(index.bytes()); i != 0; --i) {
+                auto const entry = detail::log_index_entry(index.bytes(), i - 1);
+                if(entry.offset < bytes.size()) {
+                    indexEntries  = i;
+                    validEnd      = static_cast<std::size_t>(entry.offset);
+                    nextSequence_ = entry.sequence;
+                    lastIndexed_  = validEnd;
+                    break;
+                }
+            }
+
+            auto const walk = [&] {
+                while(auto const frame = detail::log_frame<Config>(bytes.subspan(validEnd))) {
+                    validEnd += frame->size;
+                    ++nextSequence_;
+                }
+            };
+            walk();
+
+            // only a torn write at the very end may be cut off
+            while(auto const next = detail::log_resync<Config>(bytes, validEnd)) {
+                damaged       = true;
+                nextSequence_ = detail::log_sequence_after_damage<Config>(bytes,
+                                                                          index.bytes(),
+                                                                          *next,
+                                                                          std::nullopt,
+                                                                          nextSequence_);
+                validEnd      = *next;
+                walk();
+            }
+        }
+
+        if(damaged) {
+            open_segment(nextSequence_, std::ios::trunc);
+            lastIndexed_.reset();
+            return;
+        }
+
+        std::filesystem::resize_file(logPath, validEnd, error_);
+        if(!error_) {
+            std::filesystem::resize_file(indexPath,
+                                         indexEntries * sizeof(detail::LogIndexEntry),
+                                         error_);
+        }
+        if(error_) { return; }
+        segmentSize_ = validEnd;
+        open_segment(firstSequence, std::ios::app);
+    }
+
+public:
+    explicit LogWriter(std::filesystem::path directory,
+                       LogOptions            options = {})
+      : directory_{std::move(directory)}
+      , options_{options} {
+        std::error_code ec{};
+        std::filesystem::create_directories(directory_, ec);
+
+        auto const segments = detail::log_segments(directory_);
+        if(segments.empty()) {
+            open_segment(0, std::ios::trunc);
+        } else {
+            recover(segments.back());
+        }
+    }
+
+    bool is_open() const { return log_.is_open() && index_.is_open(); }
+
+    // Why cutting off the torn end of the last segment failed, the writer does not open then
+    std::error_code error() const { return error_; }
+
+    std::uint64_t next_sequence() const { return nextSequence_; }
+
+    // Appends v with its timestamp and returns the sequence number of the record. Range queries
+    // by time assume that timestamps do not decrease.
+    template<typename T>
+    std::optional<std::uint64_t> append(std::int64_t timestamp,
+                                        T const&     v) {
+        if(!is_open()) { return std::nullopt; }
+        if(segmentSize_ >= options_.segmentSize && !roll()) { return std::nullopt; }
+
+        frame_.clear();
+        Packager::pack(frame_, std::tuple<std::int64_t const&, T const&>{timestamp, v});
+
+        if(!lastIndexed_ || segmentSize_ - *lastIndexed_ >= options_.indexInterval) {
+            detail::LogIndexEntry const entry{.sequence  = nextSequence_,
+                                              .offset    = segmentSize_,
+                                              .timestamp = timestamp};
+            index_.write(reinterpret_cast<char const*>(std::addressof(entry)), sizeof(entry));
+            lastIndexed_ = segmentSize_;
+        }
+
+        log_.write(reinterpret_cast<char const*>(frame_.data()),
+                   static_cast<std::streamsize>(frame_.size()));
+        if(log_.fail() || index_.fail()) { return std::nullopt; }
+
+        segmentSize_ += frame_.size();
+        return nextSequence_++;
+    }
+
+    // Makes appended records visible to readers, the log before the index that points into it
+    bool flush() {
+        log_.flush();
+        index_.flush();
+        return !log_.fail() && !index_.fail();
+    }
+
+    // Starts a new segment with the next record
+    bool roll() {
+        if(!flush()) { return false; }
+        segmentSize_ = 0;
+        lastIndexed_.reset();
+        return open_segment(nextSequence_, std::ios::trunc);
+    }
+};
+
+// Reads the records of a log directory through read-only mappings of its segments. Seeking by
+// sequence number or timestamp binary searches the segment names and the sparse index and
+// only scans the records after the closest index entry.
+template<typename Config>
+struct LogReader {
+    struct Record {
+        std::uint64_t sequence{};
+        std::int64_t  timestamp{};
+        // serialized value inside the mapping, valid until the reader moves to another
+        // segment or refresh() remaps the current one. The value of a compressed frame is
+        // decompressed into per thread scratch space and only valid until the next one is read.
+        std::span<std::byte const> payload{};
+        // the reader skipped damaged records in front of this one
+        bool gap{};
+    };
+
+private:
+    std::filesystem::path        directory_;
+    std::vector<std::uint64_t>   segments_{};
+    std::optional<std::uint64_t> current_{};
+    detail::MappedFile           log_{};
+    detail::MappedFile           index_{};
+    std::size_t                  offset_{};
+    std::uint64_t                sequence_{};
+    bool                         gap_{};
+
+    void map(std::uint64_t firstSequence) {
+        current_  = firstSequence;
+        log_      = detail::MappedFile{detail::log_segment_path(directory_, firstSequence, ".log")};
+        index_    = detail::MappedFile{detail::log_segment_path(directory_, firstSequence, ".idx")};
+        offset_   = 0;
+        sequence_ = firstSequence;
+        gap_      = false;
+    }
+
+    // Remaps the current segment if it grew since it was mapped
+    bool remap() {
+        if(!current_) { return false; }
+        std::error_code ec{};
+        auto const      size
+          = std::filesystem::file_size(detail::log_segment_path(directory_, *current_, ".log"), ec);
+        if(ec || size == log_.bytes().size()) { return false; }
+        log_   = detail::MappedFile{detail::log_segment_path(directory_, *current_, ".log")};
+        index_ = detail::MappedFile{detail::log_segment_path(directory_, *current_, ".idx")};
+        offset_ = std::min(offset_, log_.bytes().size());
+        return true;
+    }
+
+    // Called at the end of the current segment, the writer may have added more records to it
+    // before it started the next one
+    bool advance() {
+        if(!current_) { return false; }
+        if(remap()) { return true; }
+        auto const next = std::ranges::upper_bound(segments_, *current_);
+        if(next == segments_.end()) { return false; }
+        map(*next);
+        return true;
+    }
+
+    std::optional<detail::LogFrame> frame() const {
+        if(!current_) { return std::nullopt; }
+        return detail::log_frame<Config>(log_.bytes().subspan(offset_));
+    }
+
+    // Moves past a damaged record to the next intact one of the current segment. A frame that
+    // is not completely written yet is waited for.
+    bool resync() {
+        if(!current_) { return false; }
+        auto const bytes = log_.bytes();
+        if(!detail::log_damaged<Config>(bytes.subspan(offset_))) { return false; }
+        auto const next = detail::log_resync<Config>(bytes, offset_);
+        if(!next) { return false; }
+
+        auto const nextSegment = std::ranges::upper_bound(segments_, *current_);
+        sequence_              = detail::log_sequence_after_damage<Config>(
+          bytes,
+          index_.bytes(),
+          *next,
+          nextSegment == segments_.end() ? std::nullopt : std::optional{*nextSegment},
+          sequence_);
+        offset_ = *next;
+        gap_    = true;
+        return true;
+    }
+
+    // Positions at the closest index entry before the first one that satisfies after
+    template<typename Predicate>
+    void seek_index(Predicate&& after) {
+        auto const index   = index_.bytes();
+        auto const entries = std::views::iota(std::size_t{}, detail::log_index_size(index));
+        auto const found   = static_cast<std::size_t>(std::ranges::distance(
+          entries.begin(),
+          std::ranges::partition_point(entries, [&](std::size_t i) {
+              auto const entry = detail::log_index_entry(index, i);
+              return !after(entry) && entry.offset <= log_.bytes().size();
+          })));
+        if(found != 0) {
+            auto const entry = detail::log_index_entry(index, found - 1);
+            offset_          = static_cast<std::size_t>(entry.offset);
+            sequence_        = entry.sequence;
+        }
+    }
+
+public:
+    explicit LogReader(std::filesystem::path directory) : directory_{std::move(directory)} {
+        refresh();
+    }
+
+    // Picks up new segments and records appended since the last call, for tailing a live log
+    void refresh() {
+        segments_ = detail::log_segments(directory_);
+        if(!current_) {
+            if(!segments_.empty()) { map(segments_.front()); }
+        } else {
+            remap();
+        }
+    }
+
+    std::optional<Record> next() {
+        while(current_) {
+            if(auto const f = frame()) {
+                Record const record{.sequence  = sequence_,
+                                    .timestamp = f->timestamp,
+                                    .payload   = f->payload,
+                                    .gap       = gap_};
+                offset_ += f->size;
+                ++sequence_;
+                gap_ = false;
+                return record;
+            }
+            if(resync()) { continue; }
+            // end of the segment, the last segment might still be written to
+            auto const damaged = detail::log_damaged<Config>(log_.bytes().subspan(offset_));
+            if(!advance()) { return std::nullopt; }
+            gap_ = gap_ || damaged;
+        }
+        return std::nullopt;
+    }
+
+    // Positions before the record with the given sequence number, returns false if it does not
+    // exist (yet)
+    bool seek(std::uint64_t sequence) {
+        auto const segment = std::ranges::upper_bound(segments_, sequence);
+        if(segment == segments_.begin()) { return false; }
+        map(*std::prev(segment));
+        seek_index([&](detail::LogIndexEntry const& entry) { return entry.sequence > sequence; });
+
+        while(sequence_ < sequence) {
+            auto const f = frame();
+            if(!f) {
+                if(!resync() && !advance()) { return false; }
+                continue;
+            }
+            offset_ += f->size;
+            ++sequence_;
+        }
+        return sequence_ == sequence && frame().has_value();
+    }
+
+    // Positions before the first record with a timestamp not less than timestamp, returns false
+    // if there is none (yet)
+    bool seek_time(std::int64_t timestamp) {
+        if(segments_.empty()) { return false; }
+
+        auto const first_timestamp = [&](std::uint64_t firstSequence) {
+            detail::MappedFile const index{
+              detail::log_segment_path(directory_, firstSequence, ".idx")};
+            if(detail::log_index_size(index.bytes()) == 0) { return timestamp; }
+            return detail::log_index_entry(index.bytes(), 0).timestamp;
+        };
+        auto const segment = std::ranges::partition_point(segments_, [&](std::uint64_t first) {
+            return first_timestamp(first) < timestamp;
+        });
+        map(segment == segments_.begin() ? segments_.front() : *std::prev(segment));
+        seek_index(
+          [&](detail::LogIndexEntry const& entry) { return entry.timestamp >= timestamp; });
+
+        while(true) {
+            auto const f = frame();
+            if(!f) {
+                if(!resync() && !advance()) { return false; }
+                continue;
+            }
+            if(f->timestamp >= timestamp) { return true; }
+            offset_ += f->size;
+            ++sequence_;
+        }
+    }
+
+    template<typename T>
+    static bool decode(Record const& record,
+                       T&            v) {
+        auto                              payload = record.payload;
+        aglio::DynamicDeserializationView debuff{payload};
+        return aglio::Serializer<typename Config::Size_t>::deserialize(debuff, v)
+            && debuff.available() == 0;
+    }
+};
+
+}   // namespace aglio
+
+#undef AGLIO_LOG_MMAP
@@ -1,21 +1,39 @@
 #pragma once
 
+#include "byte_order.hpp"
+#include "compression.hpp"
+#include "crc.hpp"
+#include "gather_buffer.hpp"
+#include "scan.hpp"
 #include "serialization_buffers.hpp"
 #include "serializer.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
 #include <cstddef>
+#include <cstring>
 #include <functional>
+#include <iterator>
 #include <optional>
 #include <ranges>
 #include <span>
+#include <vector>
 
 namespace aglio {
 
 namespace detail {
 
+    template<typename Packager>
+    struct FrameAccess;
+
     template<typename Serializer, typename Config_>
     struct Packager {
     private:
+        template<typename>
+        friend struct FrameAccess;
+
         struct Config : Config_ {
             struct NoCrc {
                 using type = std::uint8_t;
@@ -56,24 +74,61 @@ namespace detail {
                     return std::uint8_t{};
                 }
             }();
-            using Size_t                  = typename Config_::Size_t;
+            static constexpr bool UseCompression = [] {
+                if constexpr(requires { typename Config_::Compression; }) {
+                    return true;
+                } else {
+                    return false;
+                }
+            }();
+            static constexpr std::size_t CompressionThreshold = [] {
+                if constexpr(requires { Config_::CompressionThreshold; }) {
+                    return std::size_t{Config_::CompressionThreshold};
+                } else {
+                    return std::size_t{64};
+                }
+            }();
+            using Size_t                  = size_type_t<typename Config_::Size_t>;
             static constexpr auto MaxSize = [] {
                 if constexpr(requires { Config_::MaxSize; }) {
                     return Config_::MaxSize;
+                } else if constexpr(UseCompression) {
+                    return static_cast<Size_t>(std::numeric_limits<Size_t>::max() >> 1);
                 } else {
                     return std::numeric_limits<Size_t>::max();
                 }
             }();
+            // what a compressed frame may claim to unpack to, larger bodies are sent as they are
+            static constexpr std::size_t MaxUncompressedSize = [] {
+                if constexpr(requires { Config_::MaxUncompressedSize; }) {
+                    return std::size_t{Config_::MaxUncompressedSize};
+                } else {
+                    return std::min(static_cast<std::size_t>(MaxSize), std::size_t{1} << 20);
+                }
+            }();
         };
 
         using PackageStart_t = std::remove_cvref_t<decltype(Config::PackageStart)>;
         using Crc_t          = std::remove_cvref_t<typename Config::Crc::type>;
         using Size_t         = std::remove_cvref_t<typename Config::Size_t>;
 
+        // header fields and the crc trailer follow the byte order of the Size_t policy
+        static constexpr std::endian ByteOrder = policy<typename Config_::Size_t>::byte_order;
+
         static constexpr PackageStart_t PackageStart{Config::PackageStart};
-        static constexpr std::byte      FirstByte{PackageStart & 0xFF};
+        static constexpr auto PackageStartBytes = to_bytes<ByteOrder>(PackageStart);
         static constexpr Size_t         MaxSize{Config::MaxSize};
 
+        static constexpr std::size_t MaxUncompressedSize{Config::MaxUncompressedSize};
+
+        // per thread scratch buffers keep up to this much memory between frames
+        static constexpr std::size_t ScratchRetainSize{64 * 1024};
+
+        // the top bit of the size field marks compressed frames
+        static constexpr Size_t CompressedFlag{
+          Config::UseCompression ? static_cast<Size_t>(Size_t{1} << (sizeof(Size_t) * 8 - 1))
+                                 : Size_t{}};
+
         static_assert(std::is_trivial_v<PackageStart_t> || Config::UsePackageStart == false,
                       "start needs to by trivial");
         static_assert(std::is_trivial_v<Crc_t> || Config::UseCrc == false,
@@ -82,8 +137,10 @@ namespace detail {
                       "size needs to by trivial");
         static_assert(std::numeric_limits<Size_t>::max() >= MaxSize,
                       "max size needs to fit into Size_t");
-        static_assert(std::endian::native == std::endian::little,
-                      "needs little endian");
+        static_assert(!Config::UseCompression || MaxSize < CompressedFlag,
+                      "with compression the top bit of Size_t is the compressed flag");
+        static_assert(!Config::UseCompression || MaxUncompressedSize < CompressedFlag,
+                      "max uncompressed size needs to fit into Size_t without the compressed flag");
 
         static constexpr std::size_t PackageStartSize{
           Config::UsePackageStart ? sizeof(PackageStart_t) : 0};
@@ -154,173 +211,504 @@ namespace detail {
             }
         };
 
+        template<typename Buffer>
+        using BodyBuffer = BufferAdapter<BufferAdapter<Buffer>>;
+
+        // Body crc computed while serializing instead of in a second pass over the frame
+        template<typename T,
+                 typename Buffer>
+        static constexpr bool IncrementalCrc
+          = Config::UseCrc && incremental_crc<typename Config::Crc>
+         && requires(Buffer& bodyBuffer, T const& v, Crc_t crc) {
+                {
+                    Serializer::template serialize<typename Config::Crc>(bodyBuffer, v, crc)
+                } -> std::same_as<Crc_t>;
+            };
+
+        // A compressed body only exists once it is serialized, so pack computes its crc after
+        template<typename T,
+                 typename Buffer>
+        static constexpr bool StreamedCrc = IncrementalCrc<T, Buffer> && !Config::UseCompression;
+
+        template<typename T>
+        static constexpr void store(T const& v,
+                                    auto*    out) {
+            auto const bytes = to_bytes<ByteOrder>(v);
+            std::memcpy(out, bytes.data(), bytes.size());
+        }
+
+        template<typename T>
+        static constexpr T load(std::span<std::byte const> in) {
+            return from_bytes<ByteOrder, T>(in);
+        }
+
+        template<typename HeaderBuffer>
+        static constexpr void write_header(HeaderBuffer&& headerBuffer,
+                                           Size_t         bodySize,
+                                           bool           compressed = false) {
+            if constexpr(Config::UsePackageStart) {
+                store(PackageStart, headerBuffer.data());
+            }
+
+            store(compressed ? static_cast<Size_t>(bodySize | CompressedFlag) : bodySize,
+                  std::next(headerBuffer.data(), PackageStartSize));
+
+            if constexpr(Config::UseHeaderCrc) {
+                auto const headerCrc
+                  = Config::Crc::calc(std::as_bytes(std::span(std::ranges::subrange(
+                    headerBuffer.begin(),
+                    std::next(headerBuffer.begin(), PackageStartSize + PackageSizeSize)))));
+
+                store(headerCrc,
+                      std::next(headerBuffer.data(), PackageStartSize + PackageSizeSize));
+            }
+        }
+
+        template<typename BodyBuffer>
+        static constexpr void append_crc(BodyBuffer& bodyBuffer,
+                                         Crc_t       crc) {
+            BufferAdapter<BodyBuffer> crcBuffer{bodyBuffer};
+            crcBuffer.resize(CrcSize);
+            store(crc, crcBuffer.data());
+            crcBuffer.finalize();
+        }
+
+        enum class ScratchUse { Compress, Decompress };
+
+        // size bytes of per thread scratch space that are not zeroed. What an unusually large
+        // frame grew it to is released with the next frame that fits into ScratchRetainSize.
+        template<ScratchUse>
+        static std::span<std::byte> scratch(std::size_t size) {
+            using Scratch = std::vector<std::byte, default_init_allocator<std::byte>>;
+            thread_local Scratch buffer{};
+            if(size <= ScratchRetainSize && buffer.capacity() > ScratchRetainSize) {
+                Scratch{}.swap(buffer);
+            }
+            buffer.resize(size);
+            return buffer;
+        }
+
+        // Replaces a body of at least CompressionThreshold bytes by its size and the compressed
+        // bytes when that is smaller. The body buffer itself only ever shrinks.
+        template<typename BodyBuffer>
+        static bool compress_body(BodyBuffer& bodyBuffer) {
+            if constexpr(Config::UseCompression) {
+                using Compression = typename Config::Compression;
+
+                auto const size = bodyBuffer.size();
+                if(size < Config::CompressionThreshold || size > MaxUncompressedSize) {
+                    return false;
+                }
+
+                auto const bytes      = std::as_writable_bytes(std::span{bodyBuffer.data(), size});
+                auto const compressed = scratch<ScratchUse::Compress>(Compression::bound(size));
+                auto const compressedSize = Compression::compress(bytes, compressed);
+                if(sizeof(Size_t) + compressedSize >= size) { return false; }
+
+                store(static_cast<Size_t>(size), bytes.data());
+                std::memcpy(bytes.subspan(sizeof(Size_t)).data(),
+                            compressed.data(),
+                            compressedSize);
+                bodyBuffer.resize(sizeof(Size_t) + compressedSize);
+                return true;
+            } else {
+                return false;
+            }
+        }
+
     public:
         template<typename T,
                  typename Buffer>
         static constexpr void pack(Buffer&  buffer,
                                    T const& v) {
+            std::optional<std::size_t> knownBodySize{};
+            if constexpr(requires { Serializer::serialized_size(v); }) {
+                if constexpr(StreamedCrc<T, BodyBuffer<Buffer>> && !Config::UseHeaderCrc) {
+                    knownBodySize = Serializer::serialized_size(v);
+                } else if constexpr(requires { buffer.reserve(std::size_t{}); }) {
+                    // a reused buffer with room left grows on its own, counting walks v twice
+                    if(buffer.capacity() == buffer.size()) {
+                        knownBodySize = Serializer::serialized_size(v);
+                    }
+                }
+            }
+
+            if constexpr(requires { buffer.reserve(std::size_t{}); }) {
+                if(knownBodySize) {
+                    auto const required = buffer.size() + HeaderSize + *knownBodySize + CrcSize;
+                    if(required > buffer.capacity()) {
+                        buffer.reserve(std::max(required, buffer.capacity() * 2));
+                    }
+                }
+            }
+
             BufferAdapter<Buffer> headerBuffer{buffer};
             headerBuffer.resize(HeaderSize);
 
             BufferAdapter<decltype(headerBuffer)> bodyBuffer{headerBuffer};
+
+            if constexpr(StreamedCrc<T, BodyBuffer<Buffer>>) {
+                using Crc = typename Config::Crc;
+
+                if constexpr(Config::UseHeaderCrc) {
+                    auto const bodyCrc = Crc::finalize(
+                      Serializer::template serialize<Crc>(bodyBuffer, v, Crc::init()));
+                    bodyBuffer.finalize();
+                    append_crc(bodyBuffer, bodyCrc);
+                    write_header(headerBuffer,
+                                 static_cast<Size_t>(bodyBuffer.finalized_size() + CrcSize));
+                    return;
+                } else {
+                    if(knownBodySize) {
+                        // the crc covers the header, which needs the size before the body exists
+                        write_header(headerBuffer, static_cast<Size_t>(*knownBodySize + CrcSize));
+                        auto const headerCrc = Crc::update(
+                          Crc::init(),
+                          std::as_bytes(std::span{headerBuffer.data(), HeaderSize}));
+                        auto const bodyCrc = Crc::finalize(
+                          Serializer::template serialize<Crc>(bodyBuffer, v, headerCrc));
+                        bodyBuffer.finalize();
+                        append_crc(bodyBuffer, bodyCrc);
+                        return;
+                    }
+                }
+            }
+
             Serializer::serialize(bodyBuffer, v);
+            bool const compressed = compress_body(bodyBuffer);
             bodyBuffer.finalize();
 
             if constexpr(Config::UseCrc && Config::UseHeaderCrc) {
-                BufferAdapter<decltype(bodyBuffer)> crcBuffer{bodyBuffer};
-                auto const                          bodyCrc = Config::Crc::calc(std::as_bytes(
-                  std::span(std::ranges::subrange(bodyBuffer.begin(), bodyBuffer.end()))));
+                append_crc(bodyBuffer,
+                           Config::Crc::calc(std::as_bytes(std::span(
+                             std::ranges::subrange(bodyBuffer.begin(), bodyBuffer.end())))));
+            }
+
+            write_header(headerBuffer,
+                         static_cast<Size_t>(bodyBuffer.finalized_size() + CrcSize),
+                         compressed);
+
+            if constexpr(Config::UseCrc && !Config::UseHeaderCrc) {
+                append_crc(bodyBuffer,
+                           Config::Crc::calc(std::as_bytes(std::span(
+                             std::ranges::subrange(headerBuffer.begin(), bodyBuffer.end())))));
+            }
+        }
 
-                crcBuffer.resize(CrcSize);
-                std::memcpy(crcBuffer.data(), std::addressof(bodyCrc), CrcSize);
-                crcBuffer.finalize();
+        // Appends the frame of v to gather as a list of segments. Large contiguous trivial
+        // ranges are referenced in place and have to stay alive until the segments are sent.
+        // The body is never compressed.
+        template<typename T>
+        static void pack_gather(GatherBuffer& gather,
+                                T const&      v) {
+            static_assert(!Config::UseCrc || IncrementalCrc<T, GatherBuffer>,
+                          "scatter-gather packing needs a Crc with init/update/finalize");
+
+            auto const headerOffset = gather.size();
+            gather.insert(std::array<std::byte, HeaderSize>{});
+            auto const bodyOffset = gather.size();
+
+            auto header = [&] { return gather.overwrite(headerOffset, HeaderSize); };
+
+            if constexpr(Config::UseCrc) {
+                using Crc = typename Config::Crc;
+
+                Crc_t                      crc = Crc::init();
+                std::optional<std::size_t> bodySize{};
+                if constexpr(!Config::UseHeaderCrc) {
+                    // a body that fails to serialize gets its real size afterwards and a crc
+                    // over a different header, so that it is dropped as corrupt
+                    bodySize = Serializer::serialized_size(v);
+                    if(bodySize) {
+                        write_header(header(), static_cast<Size_t>(*bodySize + CrcSize));
+                    }
+                    crc = Crc::update(crc, header());
+                }
+                crc = Serializer::template serialize<Crc>(gather, v, crc);
+                if(!bodySize) {
+                    write_header(header(),
+                                 static_cast<Size_t>(gather.size() - bodyOffset + CrcSize));
+                }
+                crc = Crc::finalize(crc);
+                gather.insert(to_bytes<ByteOrder>(crc));
+            } else {
+                Serializer::serialize(gather, v);
+                write_header(header(), static_cast<Size_t>(gather.size() - bodyOffset));
             }
+        }
+
+    private:
+        enum class HeaderStatus { Valid, Incomplete, Invalid };
 
-            Size_t const bodySize
-              = static_cast<Config::Size_t>(bodyBuffer.finalized_size() + CrcSize);
+        struct Header {
+            HeaderStatus status{};
+            std::size_t  frameSize{};
+        };
 
+        // Validates the frame header at the start of span
+        static constexpr Header check_header(std::span<std::byte const> span) {
             if constexpr(Config::UsePackageStart) {
-                std::memcpy(headerBuffer.data(), std::addressof(PackageStart), PackageStartSize);
+                if(PackageStartSize > span.size()) { return {.status = HeaderStatus::Incomplete}; }
+
+                auto const read_packageStart = load<PackageStart_t>(span);
+
+                if(read_packageStart != PackageStart) {
+                    return {.status = HeaderStatus::Invalid};
+                }
             }
 
-            std::memcpy(std::next(headerBuffer.data(), PackageStartSize),
-                        std::addressof(bodySize),
-                        PackageSizeSize);
+            if(HeaderSize + CrcSize > span.size()) { return {.status = HeaderStatus::Incomplete}; }
 
-            if constexpr(Config::UseCrc && !Config::UseHeaderCrc) {
-                BufferAdapter<decltype(bodyBuffer)> crcBuffer{bodyBuffer};
-                auto const                          bodyCrc = Config::Crc::calc(std::as_bytes(
-                  std::span(std::ranges::subrange(headerBuffer.begin(), bodyBuffer.end()))));
+            if constexpr(Config::UseHeaderCrc) {
+                auto const read_headerCrc
+                  = load<Crc_t>(span.subspan(PackageStartSize + PackageSizeSize));
 
-                crcBuffer.resize(CrcSize);
-                std::memcpy(crcBuffer.data(), std::addressof(bodyCrc), CrcSize);
-                crcBuffer.finalize();
+                auto const calced_headerCrc
+                  = Config::Crc::calc(span.first(PackageStartSize + PackageSizeSize));
+
+                if(calced_headerCrc != read_headerCrc) { return {.status = HeaderStatus::Invalid}; }
             }
 
-            if constexpr(Config::UseHeaderCrc) {
-                auto const headerCrc
-                  = Config::Crc::calc(std::as_bytes(std::span(std::ranges::subrange(
-                    headerBuffer.begin(),
-                    std::next(headerBuffer.begin(), PackageStartSize + PackageSizeSize)))));
+            auto const read_bodySize = static_cast<Size_t>(
+              load<Size_t>(span.subspan(PackageStartSize)) & static_cast<Size_t>(~CompressedFlag));
+
+            if(read_bodySize > MaxSize || CrcSize > read_bodySize) {
+                return {.status = HeaderStatus::Invalid};
+            }
+
+            return {.status = HeaderStatus::Valid, .frameSize = HeaderSize + read_bodySize};
+        }
 
-                std::memcpy(std::next(headerBuffer.data(), PackageStartSize + PackageSizeSize),
-                            std::addressof(headerCrc),
-                            CrcSize);
+        // Verifies the body crc of a complete frame whose header passed check_header
+        static constexpr bool check_body(std::span<std::byte const> frame) {
+            if constexpr(Config::UseCrc) {
+                auto const read_bodyCrc = load<Crc_t>(frame.last(CrcSize));
+
+                auto const calced_bodyCrc = Config::Crc::calc(
+                  frame.subspan(Config::UseHeaderCrc ? HeaderSize : 0).first(
+                    frame.size() - CrcSize - (Config::UseHeaderCrc ? HeaderSize : 0)));
+                return calced_bodyCrc == read_bodyCrc;
+            } else {
+                return true;
             }
         }
 
+        // Body bytes of a complete frame whose header passed check_header, as they are sent
+        static constexpr std::span<std::byte const> frame_body(std::span<std::byte const> frame) {
+            return frame.subspan(HeaderSize, frame.size() - HeaderSize - CrcSize);
+        }
+
+        // Body of a complete frame whose header passed check_header, decompressed if the frame
+        // is compressed. A compressed body is the uncompressed size followed by the compressed
+        // bytes. It is unpacked into per thread scratch space, so the returned span and
+        // zero-copy views deserialized from it are only valid until the next compressed frame
+        // is unpacked.
+        static std::optional<std::span<std::byte const>>
+          uncompressed_body(std::span<std::byte const> frame) {
+            auto const body = frame_body(frame);
+            if constexpr(Config::UseCompression) {
+                if((load<Size_t>(frame.subspan(PackageStartSize)) & CompressedFlag) != 0) {
+                    if(body.size() < sizeof(Size_t)) { return std::nullopt; }
+                    auto const size = load<Size_t>(body);
+                    if(size > MaxUncompressedSize) { return std::nullopt; }
+
+                    auto const buffer = scratch<ScratchUse::Decompress>(size);
+                    if(!Config::Compression::decompress(body.subspan(sizeof(Size_t)), buffer)) {
+                        return std::nullopt;
+                    }
+                    return buffer;
+                }
+            }
+            return body;
+        }
+
+        template<typename T>
+        static constexpr bool deserialize_body(std::span<std::byte const> frame,
+                                               T&                         v) {
+            auto const body = uncompressed_body(frame);
+            if(!body) { return false; }
+
+            auto s = *body;
+
+            auto ec = Serializer::deserialize(s, v);
+
+            return !ec && ec.location == s.size();
+        }
+
+        // Offset of the next possible frame start after a rejected one at the start of span
+        static constexpr std::size_t resync_offset(std::span<std::byte const> span) {
+            if constexpr(Config::UsePackageStart) {
+                return 1 + find_pattern(span.subspan(1), PackageStartBytes);
+            } else {
+                return 1;
+            }
+        }
+
+    public:
         template<typename T,
                  typename Buffer>
         static constexpr std::optional<std::size_t> unpack(Buffer& buffer,
                                                            T&      v) {
-            std::span span{buffer};
+            auto const  bytes = std::as_bytes(std::span{buffer});
+            std::size_t position{};
 
             while(true) {
-                auto skip = [&]() {
-                    span = span.subspan(1);
+                auto const span   = bytes.subspan(position);
+                auto const header = check_header(span);
 
-                    if constexpr(Config::UsePackageStart) {
-                        auto const pos = std::find_if(span.begin(), span.end(), [](auto b) {
-                            return std::byte{b} == FirstByte;
-                        });
+                if(header.status == HeaderStatus::Incomplete) { return std::nullopt; }
+                if(header.status == HeaderStatus::Invalid) {
+                    position += resync_offset(span);
+                    continue;
+                }
 
-                        span = span.subspan(
-                          static_cast<std::size_t>(std::distance(span.begin(), pos)));
-                    }
-                };
-                if(HeaderSize + CrcSize > span.size()) { return std::nullopt; }
+                if(header.frameSize > span.size()) { return std::nullopt; }
 
-                if constexpr(Config::UsePackageStart) {
-                    PackageStart_t read_packageStart{};
+                auto const frame = span.first(header.frameSize);
+                if(!check_body(frame) || !deserialize_body(frame, v)) {
+                    position += resync_offset(span);
+                    continue;
+                }
 
-                    std::memcpy(std::addressof(read_packageStart), span.data(), PackageStartSize);
+                return position + header.frameSize;
+            }
+        }
 
-                    if(read_packageStart != PackageStart) {
-                        skip();
-                        continue;
-                    }
-                }
+        struct UnpackResult {
+            std::size_t consumed{};
+            std::size_t decoded{};
+            std::size_t discarded{};
+        };
 
-                if constexpr(Config::UseHeaderCrc) {
-                    Crc_t read_headerCrc{};
-                    std::memcpy(std::addressof(read_headerCrc),
-                                std::next(span.data(), PackageStartSize + PackageSizeSize),
-                                CrcSize);
-
-                    auto const calced_headerCrc
-                      = Config::Crc::calc(std::as_bytes(std::span(std::ranges::subrange(
-                        span.begin(),
-                        std::next(span.begin(), PackageStartSize + PackageSizeSize)))));
-
-                    if(calced_headerCrc != read_headerCrc) {
-                        skip();
-                        continue;
-                    }
-                }
+        // Decodes every complete frame in buffer and hands it to out, which is either a
+        // callback taking T&& or an output iterator. consumed is the offset of the first
+        // byte that might still belong to an incomplete frame. discarded counts the stretches
+        // of bytes skipped between decoded frames, each one garbage, damaged frames or both.
+        template<typename T,
+                 typename Buffer,
+                 typename Out>
+        static constexpr UnpackResult unpack_all(Buffer& buffer,
+                                                 Out&&   out) {
+            auto const   bytes = std::as_bytes(std::span{buffer});
+            UnpackResult result{};
+            bool         skipping{};
+
+            // resync moves on by a byte or to the next start pattern, every step of one
+            // stretch of damage would otherwise count on its own
+            auto const skip = [&](std::span<std::byte const> span) {
+                result.consumed += resync_offset(span);
+                if(!skipping) { ++result.discarded; }
+                skipping = true;
+            };
 
-                Size_t read_bodySize{};
-                std::memcpy(std::addressof(read_bodySize),
-                            std::next(span.data(), PackageStartSize),
-                            PackageSizeSize);
+            while(true) {
+                auto const span   = bytes.subspan(result.consumed);
+                auto const header = check_header(span);
 
-                if(read_bodySize > MaxSize) {
-                    skip();
+                if(header.status == HeaderStatus::Incomplete) { break; }
+                if(header.status == HeaderStatus::Invalid) {
+                    skip(span);
                     continue;
                 }
 
-                if(HeaderSize + read_bodySize > span.size()) { return std::nullopt; }
-
-                if constexpr(Config::UseCrc) {
-                    Crc_t read_bodyCrc{};
-                    std::memcpy(std::addressof(read_bodyCrc),
-                                std::next(span.data(),
-                                          static_cast<std::make_signed_t<std::size_t>>(
-                                            (HeaderSize + read_bodySize) - CrcSize)),
-                                CrcSize);
-
-                    auto const calced_bodyCrc
-                      = Config::Crc::calc(std::as_bytes(std::span(std::ranges::subrange(
-                        std::next(span.begin(), Config::UseHeaderCrc ? HeaderSize : 0),
-                        std::next(span.begin(),
-                                  static_cast<std::make_signed_t<std::size_t>>(
-                                    (HeaderSize + read_bodySize) - CrcSize))))));
-                    if(calced_bodyCrc != read_bodyCrc) {
-                        skip();
-                        continue;
-                    }
-                }
-                auto s = span.subspan(HeaderSize, read_bodySize - CrcSize);
+                if(header.frameSize > span.size()) { break; }
 
-                auto ec = Serializer::deserialize(s, v);
-
-                if(ec) {
-                    skip();
+                auto const frame = span.first(header.frameSize);
+                T          v{};
+                if(!check_body(frame) || !deserialize_body(frame, v)) {
+                    skip(span);
                     continue;
                 }
 
-                if(ec.location != (read_bodySize - CrcSize)) {
-                    skip();
-                    continue;
+                result.consumed += header.frameSize;
+                ++result.decoded;
+                skipping = false;
+                if constexpr(std::output_iterator<std::remove_cvref_t<Out>, T>) {
+                    *out = std::move(v);
+                    ++out;
+                } else {
+                    std::invoke(out, std::move(v));
                 }
+            }
 
-                span = span.subspan(HeaderSize + read_bodySize);
+            return result;
+        }
+    };
 
-                return buffer.size() - span.size();
-            }
+    // The single steps of unpacking a frame for FrameDecoder and the log. None of them checks
+    // what the step before it is there for, they have to run in the order unpack runs them.
+    template<typename Packager>
+    struct FrameAccess {
+        using HeaderStatus = typename Packager::HeaderStatus;
+
+        static constexpr auto check_header(std::span<std::byte const> span) {
+            return Packager::check_header(span);
+        }
+
+        static constexpr bool check_body(std::span<std::byte const> frame) {
+            return Packager::check_body(frame);
+        }
+
+        static std::optional<std::span<std::byte const>>
+          uncompressed_body(std::span<std::byte const> frame) {
+            return Packager::uncompressed_body(frame);
+        }
+
+        template<typename T>
+        static constexpr bool deserialize_body(std::span<std::byte const> frame,
+                                               T&                         v) {
+            return Packager::deserialize_body(frame, v);
+        }
+
+        static constexpr std::size_t resync_offset(std::span<std::byte const> span) {
+            return Packager::resync_offset(span);
         }
     };
 
     template<typename Size_t>
     struct Serializer {
+    private:
+        // Serialization views like GatherBuffer are used as they are, containers get wrapped
+        template<typename Buffer>
+        static constexpr decltype(auto) make_view(Buffer& buffer) {
+            if constexpr(requires { buffer.insert(std::span<std::byte const>{}); }) {
+                return (buffer);
+            } else {
+                return aglio::DynamicSerializationView{buffer};
+            }
+        }
+
+    public:
         template<typename T,
                  typename Buffer>
         static void serialize(Buffer&  buffer,
                               T const& v) {
-            aglio::DynamicSerializationView sebuff{buffer};
+            auto&& sebuff = make_view(buffer);
 
             aglio::Serializer<Size_t>::serialize(sebuff, v);
         }
 
+        // Serializes v while feeding the bytes into crc, returns the updated raw register
+        template<typename Crc,
+                 typename T,
+                 typename Buffer>
+        static typename Crc::type serialize(Buffer&            buffer,
+                                            T const&           v,
+                                            typename Crc::type crc) {
+            auto&& sebuff = make_view(buffer);
+            aglio::CrcSerializationView<std::remove_reference_t<decltype(sebuff)>, Crc> crcbuff{
+              sebuff,
+              crc};
+
+            aglio::Serializer<Size_t>::serialize(crcbuff, v);
+            return crcbuff.crc();
+        }
+
+        template<typename T>
+        static constexpr std::optional<std::size_t> serialized_size(T const& v) {
+            return aglio::Serializer<Size_t>::serialized_size(v);
+        }
+
         struct parse_error final {
             bool        ec{};
             std::size_t location{};
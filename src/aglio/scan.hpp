@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+namespace aglio::detail {
+
+template<std::size_t N>
+constexpr bool matches_at(std::span<std::byte const>      data,
+                          std::size_t                     pos,
+                          std::array<std::byte, N> const& pattern) {
+    auto const n = std::min(N, data.size() - pos);
+    return std::equal(pattern.begin(),
+                      std::next(pattern.begin(), static_cast<std::ptrdiff_t>(n)),
+                      std::next(data.begin(), static_cast<std::ptrdiff_t>(pos)));
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+template<std::size_t N>
+inline std::size_t find_pattern_simd(std::span<std::byte const>      data,
+                                     std::array<std::byte, N> const& pattern,
+                                     std::size_t&                    pos) {
+    #if defined(__AVX2__)
+    using vector = __m256i;
+    auto load    = [](std::byte const* p) {
+        return _mm256_loadu_si256(reinterpret_cast<vector const*>(p));
+    };
+    auto splat = [](std::byte b) { return _mm256_set1_epi8(static_cast<char>(b)); };
+    auto match = [](vector a, vector b) {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+    };
+    #else
+    using vector = __m128i;
+    auto load    = [](std::byte const* p) {
+        return _mm_loadu_si128(reinterpret_cast<vector const*>(p));
+    };
+    auto splat = [](std::byte b) { return _mm_set1_epi8(static_cast<char>(b)); };
+    auto match = [](vector a, vector b) {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    };
+    #endif
+    constexpr std::size_t Block = sizeof(vector);
+
+    vector const first  = splat(pattern[0]);
+    vector const second = splat(pattern[N > 1 ? 1 : 0]);
+
+    // every candidate of a block is followed by at least N - 1 bytes of data
+    for(; pos + Block + N - 1 <= data.size(); pos += Block) {
+        auto const* p          = std::next(data.data(), static_cast<std::ptrdiff_t>(pos));
+        auto        candidates = match(load(p), first);
+        if constexpr(N > 1) { candidates &= match(load(std::next(p)), second); }
+        while(candidates != 0) {
+            auto const offset = pos + static_cast<std::size_t>(std::countr_zero(candidates));
+            if constexpr(N <= 2) {
+                return offset;
+            } else {
+                if(matches_at(data, offset, pattern)) { return offset; }
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    return data.size();
+}
+#endif
+
+// Offset of the first occurrence of pattern in data. A prefix of pattern at the very end of
+// data counts as an occurrence because the rest of it might still arrive. Returns data.size()
+// if there is none. The full pattern is matched in 32 (AVX2) or 16 (SSE2) byte blocks.
+template<std::size_t N>
+constexpr std::size_t find_pattern(std::span<std::byte const>      data,
+                                   std::array<std::byte, N> const& pattern) {
+    static_assert(N != 0, "empty pattern");
+    std::size_t pos{};
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    if(!std::is_constant_evaluated()) {
+        auto const found = find_pattern_simd(data, pattern, pos);
+        if(found != data.size()) { return found; }
+    }
+#endif
+
+    for(; pos < data.size(); ++pos) {
+        auto const it = std::find(std::next(data.begin(), static_cast<std::ptrdiff_t>(pos)),
+                                  data.end(),
+                                  pattern[0]);
+        pos           = static_cast<std::size_t>(std::distance(data.begin(), it));
+        if(pos == data.size() || matches_at(data, pos, pattern)) { return pos; }
+    }
+    return data.size();
+}
+
+}   // namespace aglio::detail
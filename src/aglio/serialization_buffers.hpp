@@ -1,32 +1,137 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstring>
+#include <ios>
 #include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
 #include <span>
+#include <type_traits>
+#include <utility>
 
 namespace aglio {
-template<typename Buffer>
+
+// Growth policies of DynamicSerializationView, next() returns the capacity to reserve when
+// required bytes do not fit into capacity
+struct GrowExact {
+    static constexpr std::size_t next(std::size_t,
+                                      std::size_t required) {
+        return required;
+    }
+};
+
+struct GrowDoubling {
+    static constexpr std::size_t next(std::size_t capacity,
+                                      std::size_t required) {
+        return std::max(required, capacity * 2);
+    }
+};
+
+// Allocator adapter that default-initializes instead of value-initializes, so resize() of a
+// std::vector<std::byte, default_init_allocator<std::byte>> does not zero the new bytes
+template<typename T,
+         typename Allocator = std::allocator<T>>
+struct default_init_allocator : Allocator {
+    using traits = std::allocator_traits<Allocator>;
+
+    template<typename U>
+    struct rebind {
+        using other = default_init_allocator<U, typename traits::template rebind_alloc<U>>;
+    };
+
+    using Allocator::Allocator;
+
+    template<typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new(static_cast<void*>(p)) U;
+    }
+
+    template<typename U,
+             typename... Args>
+    void construct(U*      p,
+                   Args&&... args) {
+        traits::construct(static_cast<Allocator&>(*this), p, std::forward<Args>(args)...);
+    }
+};
+
+template<typename Buffer,
+         typename Growth = GrowDoubling>
 struct DynamicSerializationView {
 private:
     Buffer&     buffer_;
     std::size_t position_{};
 
+    constexpr void grow(std::size_t required) {
+        if constexpr(requires {
+                         buffer_.capacity();
+                         buffer_.reserve(std::size_t{});
+                     })
+        {
+            auto const capacity = static_cast<std::size_t>(buffer_.capacity());
+            if(required > capacity) {
+                buffer_.reserve(
+                  static_cast<decltype(buffer_.capacity())>(Growth::next(capacity, required)));
+            }
+        }
+    }
+
 public:
     constexpr explicit DynamicSerializationView(Buffer& buffer) : buffer_{buffer} {}
 
+    // Reserves room for reserveHint bytes upfront
+    constexpr DynamicSerializationView(Buffer&     buffer,
+                                       std::size_t reserveHint)
+      : buffer_{buffer} {
+        if constexpr(requires { buffer_.reserve(std::size_t{}); }) {
+            if(reserveHint > static_cast<std::size_t>(buffer_.capacity())) {
+                buffer_.reserve(static_cast<decltype(buffer_.capacity())>(reserveHint));
+            }
+        }
+    }
+
     constexpr std::size_t size() const { return position_; }
 
     constexpr std::byte const* data() const { return buffer_.data(); }
 
+    // Shrinks the buffer to the serialized size if it was bigger to begin with
+    constexpr void finalize() {
+        if constexpr(requires { buffer_.resize(1); }) {
+            if(static_cast<std::size_t>(buffer_.size()) > position_) {
+                buffer_.resize(static_cast<decltype(buffer_.size())>(position_));
+            }
+        }
+    }
+
     constexpr bool insert(std::span<std::byte const> data) {
         if(data.size_bytes() == 0) { return true; }
         auto available = [&]() { return static_cast<std::size_t>(buffer_.size()) - position_; };
         if(data.size_bytes() > available()) {
-            if constexpr(requires { buffer_.resize(1); }) {
-                buffer_.resize(static_cast<decltype(buffer_.size())>(
-                  static_cast<std::size_t>(buffer_.size()) + (data.size_bytes() - available())));
+            auto const required = position_ + data.size_bytes();
+            if constexpr(requires {
+                             buffer_.resize_and_overwrite(
+                               std::size_t{},
+                               [](auto*, std::size_t n) { return n; });
+                         })
+            {
+                // strings get the new bytes written in place without zeroing them first
+                grow(required);
+                buffer_.resize_and_overwrite(required, [&](auto* p, std::size_t n) {
+                    std::memcpy(
+                      std::next(p, static_cast<std::make_signed_t<std::size_t>>(position_)),
+                      data.data(),
+                      data.size_bytes());
+                    return n;
+                });
+                position_ += data.size_bytes();
+                return true;
+            } else if constexpr(requires { buffer_.resize(1); }) {
+                grow(required);
+                buffer_.resize(static_cast<decltype(buffer_.size())>(required));
             } else {
                 return false;
             }
@@ -43,6 +148,58 @@ public:
 template<typename Buffer>
 DynamicSerializationView(Buffer&) -> DynamicSerializationView<Buffer>;
 
+template<typename Buffer>
+DynamicSerializationView(Buffer&,
+                         std::size_t) -> DynamicSerializationView<Buffer>;
+
+struct CountingSerializationView {
+private:
+    std::size_t size_{};
+
+public:
+    constexpr std::size_t size() const { return size_; }
+
+    constexpr bool insert(std::span<std::byte const> data) {
+        size_ += data.size_bytes();
+        return true;
+    }
+};
+
+// Forwards to another serialization view and feeds every inserted byte into an incremental
+// Crc, so the checksum is complete when serialization ends without reading the output again
+template<typename View,
+         typename Crc>
+struct CrcSerializationView {
+private:
+    View&              view_;
+    typename Crc::type crc_;
+
+public:
+    constexpr explicit CrcSerializationView(View&              view,
+                                            typename Crc::type crc = Crc::init())
+      : view_{view}
+      , crc_{crc} {}
+
+    constexpr std::size_t size() const { return view_.size(); }
+
+    // Raw register, apply Crc::finalize for the checksum
+    constexpr typename Crc::type crc() const { return crc_; }
+
+    constexpr bool insert(std::span<std::byte const> data) {
+        if(!view_.insert(data)) { return false; }
+        crc_ = Crc::update(crc_, data);
+        return true;
+    }
+
+    constexpr bool insert_ref(std::span<std::byte const> data)
+        requires requires { view_.insert_ref(data); }
+    {
+        if(!view_.insert_ref(data)) { return false; }
+        crc_ = Crc::update(crc_, data);
+        return true;
+    }
+};
+
 template<typename Buffer>
 struct DynamicDeserializationView {
 private:
@@ -85,6 +242,52 @@ public:
 template<typename Buffer>
 DynamicDeserializationView(Buffer&) -> DynamicDeserializationView<Buffer>;
 
+// Forwards to another deserialization view and carries a memory resource. Every std::pmr
+// container that gets filled from this view allocates from resource, so a whole message can
+// come from one std::pmr::monotonic_buffer_resource.
+template<typename View>
+struct PmrDeserializationView {
+private:
+    View&                       view_;
+    std::pmr::memory_resource* resource_;
+
+public:
+    constexpr PmrDeserializationView(View&                      view,
+                                     std::pmr::memory_resource* resource)
+      : view_{view}
+      , resource_{resource} {}
+
+    constexpr std::pmr::memory_resource* resource() const { return resource_; }
+
+    constexpr std::size_t size() const { return view_.size(); }
+
+    constexpr bool extract(std::span<std::byte> data) { return view_.extract(data); }
+
+    constexpr std::size_t available() const
+        requires requires { view_.available(); }
+    {
+        return view_.available();
+    }
+
+    constexpr std::span<std::byte const> span()
+        requires requires { view_.span(); }
+    {
+        return view_.span();
+    }
+
+    constexpr void skip(std::size_t length)
+        requires requires { view_.skip(length); }
+    {
+        view_.skip(length);
+    }
+
+    constexpr void unskip(std::size_t length)
+        requires requires { view_.unskip(length); }
+    {
+        view_.unskip(length);
+    }
+};
+
 template<typename Stream>
 struct StreamSerializationView {
 private:
@@ -95,7 +298,8 @@ public:
 
     constexpr bool insert(std::span<std::byte const> data) {
         if(data.size_bytes() == 0) { return true; }
-        stream_.write(reinterpret_cast<char const*>(data.data()), data.size_bytes());
+        stream_.write(reinterpret_cast<char const*>(data.data()),
+                      static_cast<std::streamsize>(data.size_bytes()));
         return !stream_.fail();
     }
 };
@@ -116,7 +320,8 @@ public:
     constexpr bool extract(std::span<std::byte> data) {
         if(data.size_bytes() == 0) { return true; }
 
-        stream_.read(reinterpret_cast<char*>(data.data()), data.size_bytes());
+        stream_.read(reinterpret_cast<char*>(data.data()),
+                     static_cast<std::streamsize>(data.size_bytes()));
 
         return !stream_.fail();
     }
@@ -125,4 +330,123 @@ public:
 template<typename Stream>
 StreamDeserializationView(Stream&) -> StreamDeserializationView<Stream>;
 
+// Collects inserts in a staging block and hands them to the stream in BlockSize chunks.
+// Call flush() before using the stream, the destructor only flushes on a best effort basis.
+template<typename Stream,
+         std::size_t BlockSize = 4096>
+struct BufferedStreamSerializationView {
+private:
+    Stream&                          stream_;
+    std::array<std::byte, BlockSize> block_{};
+    std::size_t                      used_{};
+    std::size_t                      size_{};
+
+    bool write(std::span<std::byte const> data) {
+        stream_.write(reinterpret_cast<char const*>(data.data()),
+                      static_cast<std::streamsize>(data.size_bytes()));
+        return !stream_.fail();
+    }
+
+public:
+    explicit BufferedStreamSerializationView(Stream& stream) : stream_{stream} {}
+
+    BufferedStreamSerializationView(BufferedStreamSerializationView const&)            = delete;
+    BufferedStreamSerializationView& operator=(BufferedStreamSerializationView const&) = delete;
+
+    ~BufferedStreamSerializationView() { flush(); }
+
+    std::size_t size() const { return size_; }
+
+    bool flush() {
+        if(used_ == 0) { return true; }
+        auto const ok = write(std::span{block_}.first(used_));
+        used_         = 0;
+        return ok;
+    }
+
+    bool insert(std::span<std::byte const> data) {
+        if(data.size_bytes() == 0) { return true; }
+        size_ += data.size_bytes();
+        if(used_ + data.size_bytes() > BlockSize) {
+            if(!flush()) { return false; }
+            // large inserts bypass the block
+            if(data.size_bytes() >= BlockSize) { return write(data); }
+        }
+        std::memcpy(std::next(block_.data(), static_cast<std::make_signed_t<std::size_t>>(used_)),
+                    data.data(),
+                    data.size_bytes());
+        used_ += data.size_bytes();
+        return true;
+    }
+};
+
+template<typename Stream>
+BufferedStreamSerializationView(Stream&) -> BufferedStreamSerializationView<Stream>;
+
+// Refills a staging block from the stream in BlockSize chunks. With a known length the view
+// never reads past the message and size() reports the remaining bytes, so length prefixes can
+// be checked. Without one it reads ahead up to BlockSize bytes.
+template<typename Stream,
+         std::size_t BlockSize = 4096>
+struct BufferedStreamDeserializationView {
+private:
+    Stream&                          stream_;
+    std::array<std::byte, BlockSize> block_{};
+    std::size_t                      begin_{};
+    std::size_t                      end_{};
+    std::optional<std::size_t>       remaining_{};
+
+    std::size_t read(std::span<std::byte> data) {
+        if(remaining_) { data = data.first(std::min(data.size(), *remaining_)); }
+        if(data.empty()) { return 0; }
+        stream_.read(reinterpret_cast<char*>(data.data()),
+                     static_cast<std::streamsize>(data.size_bytes()));
+        auto const got = static_cast<std::size_t>(stream_.gcount());
+        if(remaining_) { *remaining_ -= got; }
+        return got;
+    }
+
+public:
+    explicit BufferedStreamDeserializationView(Stream& stream) : stream_{stream} {}
+
+    BufferedStreamDeserializationView(Stream&     stream,
+                                      std::size_t length)
+      : stream_{stream}
+      , remaining_{length} {}
+
+    std::size_t size() const {
+        if(remaining_) { return *remaining_ + (end_ - begin_); }
+        return std::numeric_limits<std::size_t>::max();
+    }
+
+    bool extract(std::span<std::byte> data) {
+        if(data.size_bytes() == 0) { return true; }
+
+        auto const buffered = std::min(end_ - begin_, data.size_bytes());
+        std::memcpy(data.data(),
+                    std::next(block_.data(), static_cast<std::make_signed_t<std::size_t>>(begin_)),
+                    buffered);
+        begin_ += buffered;
+        data = data.subspan(buffered);
+        if(data.empty()) { return true; }
+
+        // large extracts bypass the block
+        if(data.size_bytes() >= BlockSize) { return read(data) == data.size_bytes(); }
+
+        begin_ = 0;
+        end_   = read(block_);
+        if(end_ < data.size_bytes()) { return false; }
+        std::memcpy(data.data(), block_.data(), data.size_bytes());
+        begin_ = data.size_bytes();
+        return true;
+    }
+};
+
+template<typename Stream>
+BufferedStreamDeserializationView(Stream&) -> BufferedStreamDeserializationView<Stream>;
+
+template<typename Stream>
+BufferedStreamDeserializationView(Stream&,
+                                  std::size_t) -> BufferedStreamDeserializationView<Stream>;
+
 }   // namespace aglio
@@ -1,25 +1,137 @@
 #pragma once
 
+#include "byte_order.hpp"
+#include "serialization_buffers.hpp"
 #include "type_descriptor.hpp"
+#include "varint.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
 #include <chrono>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <ranges>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
 #include <span>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <variant>
 
 namespace aglio {
+
+// Size_t policy that writes length prefixes and variant indices as LEB128
+template<typename Size_t>
+struct Varint {};
+
+// Size_t policy that writes integers wider than one byte as (zigzag) LEB128
+template<typename Size_t>
+struct VarintIntegers {};
+
+// Size_t policies that fix the byte order of fixed size values, the default is the host's
+template<typename Size_t>
+struct LittleEndian {};
+
+template<typename Size_t>
+struct BigEndian {};
+
+// Size_t policy that starts every Described struct with a bitmap of its optional and elidable
+// members. Empty optionals and members equal to the ones of a value initialized struct are
+// left out, a left out optional is read back empty even if its default is not.
+template<typename Size_t>
+struct Compact {};
+
+// Size_t policy that packs the bool members and the enum members with a known EnumMax of every
+// Described struct into one shared bit field, and std::vector<bool> into one bit per element
+template<typename Size_t>
+struct BitPacked {};
+
+// Size_t policy that writes ranges of Described structs column by column, all values of the
+// first member, then all of the second and so on. Columns without a fixed size start with their
+// length in bytes, so Serializer::deserialize_column can skip them. Zero-copy spans of memcpyable
+// structs stay row-wise, spans of other structs are columnar like any other range.
+template<typename Size_t>
+struct Columnar {};
+
+// Specialize with a static constexpr E value holding the largest value of enum E to let
+// BitPacked store it in as few bits as that needs
+template<typename E>
+struct EnumMax;
+
 namespace detail {
 
     template<typename T>
     concept trivial = std::is_integral_v<T> || std::is_floating_point_v<T> || std::is_enum_v<T>;
 
+    template<typename Size_t>
+    struct policy {
+        using size_type = Size_t;
+
+        static constexpr bool        varint_sizes    = false;
+        static constexpr bool        varint_integers = false;
+        static constexpr std::endian byte_order      = std::endian::native;
+        static constexpr bool        compact_structs = false;
+        static constexpr bool        bit_packed      = false;
+        static constexpr bool        columnar        = false;
+    };
+
+    template<typename Size_t>
+    struct policy<Varint<Size_t>> : policy<Size_t> {
+        static_assert(std::is_unsigned_v<typename policy<Size_t>::size_type>,
+                      "varint sizes need to be unsigned");
+
+        static constexpr bool varint_sizes = true;
+    };
+
+    template<typename Size_t>
+    struct policy<VarintIntegers<Size_t>> : policy<Size_t> {
+        static constexpr bool varint_integers = true;
+    };
+
+    template<typename Size_t>
+    struct policy<LittleEndian<Size_t>> : policy<Size_t> {
+        static constexpr std::endian byte_order = std::endian::little;
+    };
+
+    template<typename Size_t>
+    struct policy<BigEndian<Size_t>> : policy<Size_t> {
+        static constexpr std::endian byte_order = std::endian::big;
+    };
+
+    template<typename Size_t>
+    struct policy<Compact<Size_t>> : policy<Size_t> {
+        static constexpr bool compact_structs = true;
+    };
+
+    template<typename Size_t>
+    struct policy<BitPacked<Size_t>> : policy<Size_t> {
+        static constexpr bool bit_packed = true;
+    };
+
+    template<typename Size_t>
+    struct policy<Columnar<Size_t>> : policy<Size_t> {
+        static constexpr bool columnar = true;
+    };
+
+    template<typename Size_t>
+    using size_type_t = typename policy<Size_t>::size_type;
+
+    // Values whose bytes have to be reversed on the way in and out
+    template<typename T, typename Size_t>
+    concept swapped = policy<Size_t>::byte_order != std::endian::native && trivial<T>
+                   && (sizeof(T) > 1);
+
+    template<typename T, typename Size_t>
+    concept varint_integer = policy<Size_t>::varint_integers && std::is_integral_v<T>
+                          && !std::is_same_v<T, bool> && (sizeof(T) > 1);
+
+
     template<typename T>
     concept is_tuple_like = requires {
         { std::tuple_size<T>::value } -> std::convertible_to<std::size_t>;
@@ -41,6 +153,38 @@ namespace detail {
         typename T::value_type;
     } && !is_map<T>;
 
+    template<typename... Ts>
+    struct type_list {};
+
+    template<typename T>
+    constexpr auto member_types() {
+        return []<std::size_t... Is>(std::index_sequence<Is...>) {
+            using std::get;
+            using tie_t = decltype(glz::to_tie(std::declval<T&>()));
+            return type_list<std::remove_cvref_t<decltype(get<Is>(std::declval<tie_t&>()))>...>{};
+        }(std::make_index_sequence<glz::reflect<T>::size>{});
+    }
+
+    template<typename T>
+    using member_types_t = decltype(member_types<T>());
+
+    template<std::size_t I,
+             typename... Ts>
+    std::type_identity<std::tuple_element_t<I, std::tuple<Ts...>>> type_at(type_list<Ts...>);
+
+    template<typename T,
+             std::size_t I>
+    using member_type_t = typename decltype(type_at<I>(member_types_t<T>{}))::type;
+
+    template<typename T>
+    concept is_flat_map = is_map<T> && requires {
+        typename T::key_container_type;
+        typename T::mapped_container_type;
+    };
+
+    template<typename T>
+    concept is_flat_set = is_set<T> && requires { typename T::container_type; };
+
     template<typename T>
     struct remove_pair_const;
 
@@ -62,54 +206,790 @@ namespace detail {
         using type = typename remove_pair_const<typename T::value_type>::type;
     };
 
+    template<typename T>
+    concept pmr_allocated = requires { typename T::allocator_type; }
+                         && std::is_same_v<typename T::allocator_type,
+                                           std::pmr::polymorphic_allocator<
+                                             typename T::allocator_type::value_type>>;
+
+    // Views with resource() make the std::pmr containers they fill allocate from it. A pmr
+    // allocator never propagates on assignment, so the container is recreated in place.
+    template<typename T,
+             typename Buffer>
+    void adopt_resource(T&      v,
+                        Buffer& buffer) {
+        if constexpr(pmr_allocated<T> && requires { buffer.resource(); }) {
+            auto* const resource = buffer.resource();
+            if(v.get_allocator().resource() != resource) {
+                std::destroy_at(std::addressof(v));
+                std::construct_at(std::addressof(v), typename T::allocator_type{resource});
+            }
+        }
+    }
+
+    // Temporary element of container v, allocator aware elements use the allocator of v
+    template<typename T,
+             typename Container>
+    constexpr T make_element(Container const& v) {
+        if constexpr(requires { v.get_allocator(); }) {
+            return std::make_obj_using_allocator<T>(v.get_allocator());
+        } else {
+            return T{};
+        }
+    }
 }   // namespace detail
 
 template<typename T, typename Size_t>
 struct serializer;
 
+namespace detail {
+    template<typename T, typename Size_t>
+    constexpr std::optional<std::size_t> fixed_size() {
+        if constexpr(requires { serializer<T, Size_t>::fixed_size; }) {
+            return serializer<T, Size_t>::fixed_size;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    template<typename Size_t, typename... Ts>
+    constexpr std::optional<std::size_t> fixed_size_sum() {
+        std::size_t size{};
+        bool const  fixed = ([&] {
+            auto const s = fixed_size<Ts, Size_t>();
+            if(s) { size += *s; }
+            return s.has_value();
+        }() && ...);
+        if(!fixed) { return std::nullopt; }
+        return size;
+    }
+
+    template<typename T>
+    concept bounded_enum = std::is_enum_v<T> && requires {
+        { EnumMax<T>::value } -> std::convertible_to<T>;
+    };
+
+    // Bits of a member in the bit field of BitPacked structs, 0 when it is written on its own
+    template<typename T, typename Size_t>
+    consteval std::size_t packed_width() {
+        if constexpr(!policy<Size_t>::bit_packed) {
+            return 0;
+        } else if constexpr(std::is_same_v<T, bool>) {
+            return 1;
+        } else if constexpr(bounded_enum<T>) {
+            using U          = std::make_unsigned_t<std::underlying_type_t<T>>;
+            auto const width = std::bit_width(static_cast<U>(EnumMax<T>::value));
+            return std::max(std::size_t{1}, static_cast<std::size_t>(width));
+        } else {
+            return 0;
+        }
+    }
+
+    // LSB first bits [offset, offset + width) of bytes
+    constexpr void put_bits(std::span<std::byte> bytes,
+                            std::size_t          offset,
+                            std::size_t          width,
+                            std::uint64_t        value) {
+        for(std::size_t i = 0; i != width; ++i) {
+            if((value >> i) & 1U) { bytes[(offset + i) / 8] |= std::byte{1} << ((offset + i) % 8); }
+        }
+    }
+
+    constexpr std::uint64_t get_bits(std::span<std::byte const> bytes,
+                                     std::size_t                offset,
+                                     std::size_t                width) {
+        std::uint64_t value{};
+        for(std::size_t i = 0; i != width; ++i) {
+            auto const byte = std::to_integer<std::uint64_t>(bytes[(offset + i) / 8]);
+            value |= ((byte >> ((offset + i) % 8)) & 1U) << i;
+        }
+        return value;
+    }
+
+    // glz::to_tie binds the members in declaration order, so a trivially copyable type whose
+    // members add up to its size has the same object representation as its member-wise encoding
+    template<typename T, typename Size_t>
+    consteval bool is_memcpyable() {
+        if constexpr(trivial<T>) {
+            return !varint_integer<T, Size_t> && !swapped<T, Size_t>;
+        } else if constexpr(Described<T> && !std::ranges::range<T>
+                            && std::is_trivially_copyable_v<T> && !policy<Size_t>::compact_structs)
+        {
+            return []<typename... Ms>(type_list<Ms...>) {
+                return (is_memcpyable<Ms, Size_t>() && ...) && (sizeof(Ms) + ... + 0) == sizeof(T)
+                    && ((packed_width<Ms, Size_t>() == 0) && ...);
+            }(member_types_t<T>{});
+        } else {
+            return false;
+        }
+    }
+
+    template<typename T, typename Size_t>
+    concept memcpyable = is_memcpyable<T, Size_t>();
+
+    template<typename T>
+    inline constexpr bool is_optional = false;
+
+    template<typename T>
+    inline constexpr bool is_optional<std::optional<T>> = true;
+
+    // Members that get a bit in the presence bitmap of Compact structs, anything else is
+    // always written
+    template<typename T>
+    concept elidable = is_optional<T> || trivial<T>
+                    || (std::ranges::range<T> && std::equality_comparable<T>);
+
+    // Floating point members compare bitwise, so that -0.0 is not replaced by 0.0
+    template<elidable T>
+    constexpr bool is_default(T const& v,
+                              T const& defaults) {
+        if constexpr(is_optional<T>) {
+            return !v.has_value();
+        } else if constexpr(std::is_floating_point_v<T>) {
+            return std::bit_cast<std::array<std::byte, sizeof(T)>>(v)
+                == std::bit_cast<std::array<std::byte, sizeof(T)>>(defaults);
+        } else {
+            return v == defaults;
+        }
+    }
+
+    // What Compact structs compare their members against
+    template<typename T>
+    T const& default_instance() {
+        static T const instance{};
+        return instance;
+    }
+
+    template<typename Size_t,
+             trivial T,
+             typename Buffer>
+    constexpr bool serialize_fixed(T const& v,
+                                   Buffer&  buffer) {
+        if constexpr(swapped<T, Size_t>) {
+            return buffer.insert(to_bytes<policy<Size_t>::byte_order>(v));
+        } else {
+            return buffer.insert(std::as_bytes(std::span{std::addressof(v), 1}));
+        }
+    }
+
+    template<typename Size_t,
+             trivial T,
+             typename Buffer>
+    constexpr bool deserialize_fixed(T&      v,
+                                     Buffer& buffer) {
+        if constexpr(swapped<T, Size_t>) {
+            std::array<std::byte, sizeof(T)> bytes{};
+            if(!buffer.extract(bytes)) { return false; }
+            v = from_bytes<policy<Size_t>::byte_order, T>(bytes);
+            return true;
+        } else {
+            return buffer.extract(std::as_writable_bytes(std::span{std::addressof(v), 1}));
+        }
+    }
+
+    // count bits LSB first, get(i) returns bit i. Gathered 64 at a time into a block that is
+    // inserted as a whole.
+    template<typename Get,
+             typename Buffer>
+    constexpr bool serialize_bits(std::size_t count,
+                                  Get&&       get,
+                                  Buffer&     buffer) {
+        std::array<std::byte, 512> block{};
+        std::size_t                used{};
+        for(std::size_t pos = 0; pos < count; pos += 64) {
+            auto const    n = std::min<std::size_t>(64, count - pos);
+            std::uint64_t word{};
+            for(std::size_t i = 0; i != n; ++i) {
+                word |= static_cast<std::uint64_t>(get(pos + i)) << i;
+            }
+            auto const bytes = to_bytes<std::endian::little>(word);
+            std::ranges::copy_n(bytes.begin(),
+                                static_cast<std::ptrdiff_t>((n + 7) / 8),
+                                block.begin() + static_cast<std::ptrdiff_t>(used));
+            used += (n + 7) / 8;
+            if(used == block.size()) {
+                if(!buffer.insert(block)) { return false; }
+                used = 0;
+            }
+        }
+        return used == 0 || buffer.insert(std::span{block}.first(used));
+    }
+
+    // Counterpart of serialize_bits, set(i, bit) receives every bit. Unused bits of the last
+    // byte have to be zero.
+    template<typename Set,
+             typename Buffer>
+    constexpr bool deserialize_bits(std::size_t count,
+                                    Set&&       set,
+                                    Buffer&     buffer) {
+        std::array<std::byte, 512> block{};
+        for(std::size_t pos = 0; pos < count;) {
+            auto const bits  = std::min(count - pos, block.size() * 8);
+            auto const chunk = std::span{block}.first((bits + 7) / 8);
+            if(!buffer.extract(chunk)) { return false; }
+            if(bits % 8 != 0 && (std::to_integer<unsigned>(chunk.back()) >> (bits % 8)) != 0) {
+                return false;
+            }
+            for(std::size_t offset = 0; offset < bits; offset += 64) {
+                auto const               n = std::min<std::size_t>(64, bits - offset);
+                std::array<std::byte, 8> bytes{};
+                std::ranges::copy(chunk.subspan(offset / 8, (n + 7) / 8), bytes.begin());
+                auto const word = from_bytes<std::endian::little, std::uint64_t>(bytes);
+                for(std::size_t i = 0; i != n; ++i) {
+                    set(pos + offset + i, ((word >> i) & 1U) != 0);
+                }
+            }
+            pos += bits;
+        }
+        return true;
+    }
+
+    // Contiguous trivial ranges in foreign byte order are swapped block wise
+    template<typename Size_t,
+             std::ranges::contiguous_range R,
+             typename Buffer>
+    bool serialize_swapped(R const& values,
+                           Buffer&  buffer) {
+        using T             = std::ranges::range_value_t<R>;
+        constexpr auto Size = sizeof(T);
+        std::array<std::byte, 512 / Size * Size> block{};
+
+        std::span<std::byte const> bytes = std::as_bytes(std::span{values});
+        while(!bytes.empty()) {
+            auto const chunk = std::min(bytes.size(), block.size());
+            std::ranges::copy(bytes.first(chunk), block.begin());
+            byteswap_elements<Size>(std::span{block}.first(chunk));
+            if(!buffer.insert(std::span{block}.first(chunk))) { return false; }
+            bytes = bytes.subspan(chunk);
+        }
+        return true;
+    }
+
+    template<typename Size_t>
+    constexpr std::size_t size_size(size_type_t<Size_t> size) {
+        if constexpr(policy<Size_t>::varint_sizes) {
+            return varint_size(size);
+        } else {
+            return sizeof(size);
+        }
+    }
+
+    template<typename Size_t,
+             typename Buffer>
+    constexpr bool serialize_size(size_type_t<Size_t> size,
+                                  Buffer&             buffer) {
+        if constexpr(policy<Size_t>::varint_sizes) {
+            return serialize_varint(size, buffer);
+        } else {
+            return serialize_fixed<Size_t>(size, buffer);
+        }
+    }
+
+    template<typename Size_t,
+             typename Buffer>
+    constexpr bool deserialize_size(size_type_t<Size_t>& size,
+                                    Buffer&              buffer) {
+        if constexpr(policy<Size_t>::varint_sizes) {
+            return deserialize_varint(size, buffer);
+        } else {
+            return deserialize_fixed<Size_t>(size, buffer);
+        }
+    }
+
+    // Contiguous memory of the caller, views with insert_ref (GatherBuffer) may reference it
+    // in place instead of copying
+    template<typename Buffer>
+    constexpr bool insert_ref(std::span<std::byte const> data,
+                              Buffer&                    buffer) {
+        if constexpr(requires { buffer.insert_ref(data); }) {
+            return buffer.insert_ref(data);
+        } else {
+            return buffer.insert(data);
+        }
+    }
+
+    // Views without skip() read the bytes into a scratch block
+    template<typename Buffer>
+    constexpr bool skip_bytes(std::size_t length,
+                              Buffer&     buffer) {
+        if constexpr(requires {
+                         buffer.skip(length);
+                         buffer.available();
+                     })
+        {
+            if(length > buffer.available()) { return false; }
+            buffer.skip(length);
+            return true;
+        } else {
+            std::array<std::byte, 512> block{};
+            while(length != 0) {
+                auto const chunk = std::min(length, block.size());
+                if(!buffer.extract(std::span{block}.first(chunk))) { return false; }
+                length -= chunk;
+            }
+            return true;
+        }
+    }
+
+    // Columns of bools are bit fields with BitPacked
+    template<typename M, typename Size_t>
+    concept bit_column = policy<Size_t>::bit_packed && std::is_same_v<M, bool>;
+
+    template<typename M, typename Size_t>
+    constexpr std::optional<std::size_t> column_size(std::size_t count) {
+        if constexpr(bit_column<M, Size_t>) {
+            return (count + 7) / 8;
+        } else if constexpr(fixed_size<M, Size_t>().has_value()) {
+            return *fixed_size<M, Size_t>() * count;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    // Columns whose size depends on the values start with their length in bytes
+    template<typename M, typename Size_t>
+    inline constexpr bool length_prefixed = !column_size<M, Size_t>(0).has_value();
+
+    template<typename T, typename Size_t>
+    constexpr std::optional<std::size_t> columns_size(std::size_t count) {
+        return [&]<typename... Ms>(type_list<Ms...>) -> std::optional<std::size_t> {
+            std::size_t size{};
+            bool const  fixed = ([&] {
+                auto const s = column_size<Ms, Size_t>(count);
+                if(s) { size += *s; }
+                return s.has_value();
+            }() && ...);
+            if(!fixed) { return std::nullopt; }
+            return size;
+        }(member_types_t<T>{});
+    }
+
+    // values yields count M const&. Trivial values are gathered into a block that is inserted
+    // as a whole.
+    template<typename M,
+             typename Size_t,
+             typename R,
+             typename Buffer>
+    constexpr bool serialize_column(R&&         values,
+                                    std::size_t count,
+                                    Buffer&     buffer) {
+        if constexpr(bit_column<M, Size_t>) {
+            // bits are requested in order, so the iterator can follow along
+            auto it = std::ranges::begin(values);
+            return serialize_bits(count, [&](std::size_t) { return *it++; }, buffer);
+        } else if constexpr(memcpyable<M, Size_t>) {
+            using Block = std::array<M, std::max<std::size_t>(1, 512 / sizeof(M))>;
+            Block block{};
+            auto  it = std::ranges::begin(values);
+            for(std::size_t pos = 0; pos < count; pos += block.size()) {
+                auto const n = std::min(block.size(), count - pos);
+                for(std::size_t i = 0; i != n; ++i) { block[i] = *it++; }
+                if(!buffer.insert(std::as_bytes(std::span{block}.first(n)))) { return false; }
+            }
+            return true;
+        } else {
+            auto const write = [&](auto& out) {
+                for(M const& m : values) {
+                    if(!serializer<M, Size_t>::serialize(m, out)) { return false; }
+                }
+                return true;
+            };
+            if constexpr(length_prefixed<M, Size_t>) {
+                using size_type = size_type_t<Size_t>;
+                CountingSerializationView counter{};
+                if(!write(counter)) { return false; }
+                if constexpr(std::numeric_limits<size_type>::max()
+                             < std::numeric_limits<std::size_t>::max())
+                {
+                    if(counter.size() > std::numeric_limits<size_type>::max()) { return false; }
+                }
+                if(!serialize_size<Size_t>(static_cast<size_type>(counter.size()), buffer)) {
+                    return false;
+                }
+            }
+            return write(buffer);
+        }
+    }
+
+    // values yields count writable M, a contiguous range of M is extracted into directly
+    template<typename M,
+             typename Size_t,
+             typename R,
+             typename Buffer>
+    constexpr bool deserialize_column(R&&         values,
+                                      std::size_t count,
+                                      Buffer&     buffer) {
+        if constexpr(bit_column<M, Size_t>) {
+            auto it = std::ranges::begin(values);
+            return deserialize_bits(count, [&](std::size_t, bool bit) { *it++ = bit; }, buffer);
+        } else if constexpr(memcpyable<M, Size_t> && std::ranges::contiguous_range<R>
+                            && std::is_same_v<std::ranges::range_value_t<R>, M>)
+        {
+            auto const bytes = std::as_writable_bytes(std::span{std::ranges::data(values), count});
+            return buffer.extract(bytes);
+        } else if constexpr(memcpyable<M, Size_t>) {
+            using Block = std::array<M, std::max<std::size_t>(1, 512 / sizeof(M))>;
+            Block block{};
+            auto  it = std::ranges::begin(values);
+            for(std::size_t pos = 0; pos < count; pos += block.size()) {
+                auto const n = std::min(block.size(), count - pos);
+                if(!buffer.extract(std::as_writable_bytes(std::span{block}.first(n)))) {
+                    return false;
+                }
+                for(std::size_t i = 0; i != n; ++i) { *it++ = block[i]; }
+            }
+            return true;
+        } else {
+            size_type_t<Size_t> length{};
+            if constexpr(length_prefixed<M, Size_t>) {
+                if(!deserialize_size<Size_t>(length, buffer) || length > buffer.size()) {
+                    return false;
+                }
+            }
+            [[maybe_unused]] std::size_t end{};
+            auto                         it = std::ranges::begin(values);
+            if constexpr(length_prefixed<M, Size_t> && requires { buffer.available(); }) {
+                if(length > buffer.available()) { return false; }
+                end = buffer.available() - length;
+            }
+            for(std::size_t i = 0; i != count; ++i) {
+                if(!serializer<M, Size_t>::deserialize(*it++, buffer)) { return false; }
+            }
+            if constexpr(length_prefixed<M, Size_t> && requires { buffer.available(); }) {
+                return buffer.available() == end;
+            }
+            return true;
+        }
+    }
+
+    template<typename M,
+             typename Size_t,
+             typename Buffer>
+    constexpr bool skip_column(std::size_t count,
+                               Buffer&     buffer) {
+        if constexpr(length_prefixed<M, Size_t>) {
+            size_type_t<Size_t> length{};
+            return deserialize_size<Size_t>(length, buffer)
+                && skip_bytes(static_cast<std::size_t>(length), buffer);
+        } else {
+            return skip_bytes(*column_size<M, Size_t>(count), buffer);
+        }
+    }
+}   // namespace detail
+
 template<detail::trivial T, typename Size_t>
 struct serializer<T, Size_t> {
+    static constexpr bool is_varint = detail::varint_integer<T, Size_t>;
+
+    static constexpr std::optional<std::size_t> fixed_size
+      = is_varint ? std::optional<std::size_t>{} : std::optional<std::size_t>{sizeof(T)};
+
     template<typename Buffer>
     static constexpr bool serialize(T const& v,
                                     Buffer&  buffer) {
-        return buffer.insert(std::as_bytes(std::span{std::addressof(v), 1}));
+        if constexpr(is_varint) {
+            return detail::serialize_varint(detail::zigzag_encode(v), buffer);
+        } else {
+            return detail::serialize_fixed<Size_t>(v, buffer);
+        }
     }
 
     template<typename Buffer>
     static constexpr bool deserialize(T&      v,
                                       Buffer& buffer) {
-        return buffer.extract(std::as_writable_bytes(std::span{std::addressof(v), 1}));
+        if constexpr(is_varint) {
+            std::make_unsigned_t<T> vv{};
+            if(!detail::deserialize_varint(vv, buffer)) { return false; }
+            v = detail::zigzag_decode<T>(vv);
+            return true;
+        } else {
+            return detail::deserialize_fixed<Size_t>(v, buffer);
+        }
     }
 };
 
 template<Described T, typename Size_t>
     requires(!std::ranges::range<T>)
 struct serializer<T, Size_t> {
+private:
+    static constexpr bool        compact = detail::policy<Size_t>::compact_structs;
+    static constexpr std::size_t no_bit  = std::numeric_limits<std::size_t>::max();
+
+    // Bits of every member in the bit field of BitPacked structs
+    static constexpr auto packed_width = []<typename... Ms>(detail::type_list<Ms...>) {
+        return std::array<std::size_t, sizeof...(Ms)>{detail::packed_width<Ms, Size_t>()...};
+    }(detail::member_types_t<T>{});
+
+    static constexpr auto packed_offset = [] {
+        std::array<std::size_t, packed_width.size()> offsets{};
+        std::size_t                                  next{};
+        for(std::size_t i = 0; i != offsets.size(); ++i) {
+            offsets[i] = next;
+            next += packed_width[i];
+        }
+        return offsets;
+    }();
+
+    static constexpr std::size_t packed_bits
+      = std::accumulate(packed_width.begin(), packed_width.end(), std::size_t{});
+
+    // Bit of every member in the presence bitmap of Compact structs
+    static constexpr auto bit_of = []<typename... Ms>(detail::type_list<Ms...>) {
+        std::array<std::size_t, sizeof...(Ms)> bits{};
+        std::size_t                            next{};
+        std::size_t                            i{};
+        ((bits[i] = compact && detail::elidable<Ms> && packed_width[i] == 0 ? next++ : no_bit, ++i),
+         ...);
+        return bits;
+    }(detail::member_types_t<T>{});
+
+    static constexpr std::size_t presence_bits
+      = static_cast<std::size_t>(std::ranges::count_if(bit_of, [](auto b) { return b != no_bit; }));
+
+    using Bitmap = std::array<std::byte, (presence_bits + 7) / 8>;
+    using Packed = std::array<std::byte, (packed_bits + 7) / 8>;
+
+    static constexpr bool test(Bitmap const& bitmap,
+                               std::size_t   bit) {
+        return (std::to_integer<unsigned>(bitmap[bit / 8]) >> (bit % 8)) & 1U;
+    }
+
+    // Bits past the last used one have to be zero
+    template<std::size_t Bits>
+    static constexpr bool valid_tail(std::span<std::byte const> bytes) {
+        if constexpr(Bits % 8 == 0) {
+            return true;
+        } else {
+            return (std::to_integer<unsigned>(bytes.back()) >> (Bits % 8)) == 0;
+        }
+    }
+
+    template<std::size_t I,
+             typename M>
+    static constexpr bool pack_member(M const& m,
+                                      Packed&  packed) {
+        if constexpr(std::is_same_v<M, bool>) {
+            detail::put_bits(packed, packed_offset[I], 1, m ? 1U : 0U);
+        } else {
+            using U          = std::make_unsigned_t<std::underlying_type_t<M>>;
+            auto const value = static_cast<U>(m);
+            if(value > static_cast<U>(EnumMax<M>::value)) { return false; }
+            detail::put_bits(packed, packed_offset[I], packed_width[I], value);
+        }
+        return true;
+    }
+
+    template<std::size_t I,
+             typename M>
+    static constexpr bool unpack_member(M&            m,
+                                        Packed const& packed) {
+        auto const value = detail::get_bits(packed, packed_offset[I], packed_width[I]);
+        if constexpr(std::is_same_v<M, bool>) {
+            m = value != 0;
+        } else {
+            using U = std::make_unsigned_t<std::underlying_type_t<M>>;
+            if(value > static_cast<U>(EnumMax<M>::value)) { return false; }
+            m = static_cast<M>(value);
+        }
+        return true;
+    }
+
+    template<std::size_t I,
+             typename M,
+             typename Buffer>
+    static constexpr bool serialize_member(M const&      m,
+                                           Bitmap const& bitmap,
+                                           Buffer&       buffer) {
+        if constexpr(packed_width[I] != 0) {
+            return true;
+        } else if constexpr(bit_of[I] == no_bit) {
+            return serializer<M, Size_t>::serialize(m, buffer);
+        } else {
+            // a set bit of a bool already says that it is the other value
+            if(std::is_same_v<M, bool> || !test(bitmap, bit_of[I])) { return true; }
+            if constexpr(detail::is_optional<M>) {
+                return serializer<typename M::value_type, Size_t>::serialize(*m, buffer);
+            } else {
+                return serializer<M, Size_t>::serialize(m, buffer);
+            }
+        }
+    }
+
+    template<std::size_t I,
+             typename M,
+             typename Buffer>
+    static constexpr bool deserialize_member(M&            m,
+                                             M const&      defaults,
+                                             Bitmap const& bitmap,
+                                             Packed const& packed,
+                                             Buffer&       buffer) {
+        if constexpr(packed_width[I] != 0) {
+            return unpack_member<I>(m, packed);
+        } else if constexpr(bit_of[I] == no_bit) {
+            return serializer<M, Size_t>::deserialize(m, buffer);
+        } else {
+            if(!test(bitmap, bit_of[I])) {
+                if constexpr(detail::is_optional<M>) {
+                    m.reset();
+                } else {
+                    m = defaults;
+                }
+                return true;
+            }
+            if constexpr(std::is_same_v<M, bool>) {
+                m = !defaults;
+                return true;
+            } else if constexpr(detail::is_optional<M>) {
+                m.emplace();
+                return serializer<typename M::value_type, Size_t>::deserialize(*m, buffer);
+            } else {
+                return serializer<M, Size_t>::deserialize(m, buffer);
+            }
+        }
+    }
+
+    // Presence bitmap and bit field first, then every member that is in neither of them
     template<typename Buffer>
-    static constexpr bool serialize(T const& v,
-                                    Buffer&  buffer) {
-        auto const tie = glz::to_tie(v);
+    static constexpr bool serialize_prefixed(T const& v,
+                                             T const& defaults,
+                                             Buffer&  buffer) {
+        auto const tie          = glz::to_tie(v);
+        auto const defaults_tie = glz::to_tie(defaults);
         return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
             using std::get;
-            return (serializer<std::remove_cvref_t<decltype(get<Is>(tie))>, Size_t>::serialize(
-                      get<Is>(tie),
-                      buffer)
-                    && ...);
+            Bitmap bitmap{};
+            Packed packed{};
+            bool const packable = ([&] {
+                if constexpr(packed_width[Is] != 0) {
+                    return pack_member<Is>(get<Is>(tie), packed);
+                } else {
+                    if constexpr(bit_of[Is] != no_bit) {
+                        if(!detail::is_default(get<Is>(tie), get<Is>(defaults_tie))) {
+                            bitmap[bit_of[Is] / 8] |= std::byte{1} << (bit_of[Is] % 8);
+                        }
+                    }
+                    return true;
+                }
+            }() && ...);
+            if(!packable) { return false; }
+            if constexpr(presence_bits != 0) {
+                if(!buffer.insert(bitmap)) { return false; }
+            }
+            if constexpr(packed_bits != 0) {
+                if(!buffer.insert(packed)) { return false; }
+            }
+            return (serialize_member<Is>(get<Is>(tie), bitmap, buffer) && ...);
         }(std::make_index_sequence<glz::reflect<T>::size>{});
     }
 
     template<typename Buffer>
-    static constexpr bool deserialize(T&      v,
-                                      Buffer& buffer) {
-        auto tie = glz::to_tie(v);
+    static constexpr bool deserialize_prefixed(T&       v,
+                                               T const& defaults,
+                                               Buffer&  buffer) {
+        Bitmap bitmap{};
+        Packed packed{};
+        if constexpr(presence_bits != 0) {
+            if(!buffer.extract(bitmap) || !valid_tail<presence_bits>(bitmap)) { return false; }
+        }
+        if constexpr(packed_bits != 0) {
+            if(!buffer.extract(packed) || !valid_tail<packed_bits>(packed)) { return false; }
+        }
+        auto       tie          = glz::to_tie(v);
+        auto const defaults_tie = glz::to_tie(defaults);
         return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
             using std::get;
-            return (serializer<std::remove_cvref_t<decltype(get<Is>(tie))>, Size_t>::deserialize(
-                      get<Is>(tie),
-                      buffer)
+            return (deserialize_member<Is>(get<Is>(tie),
+                                           get<Is>(defaults_tie),
+                                           bitmap,
+                                           packed,
+                                           buffer)
                     && ...);
         }(std::make_index_sequence<glz::reflect<T>::size>{});
     }
+
+    static constexpr bool prefixed = presence_bits != 0 || packed_bits != 0;
+
+    // Only Compact structs read the defaults, everything else can pass the value itself
+    template<typename F>
+    static constexpr bool with_defaults(T const& v,
+                                        F&&      f) {
+        if constexpr(compact) {
+            if(std::is_constant_evaluated()) {
+                T const defaults{};
+                return f(defaults);
+            }
+            return f(detail::default_instance<T>());
+        } else {
+            return f(v);
+        }
+    }
+
+public:
+    static constexpr std::optional<std::size_t> fixed_size
+      = []<typename... Ms>(detail::type_list<Ms...>) -> std::optional<std::size_t> {
+            if constexpr(presence_bits != 0) {
+                return std::nullopt;
+            } else if constexpr(packed_bits != 0) {
+                std::size_t size{sizeof(Packed)};
+                std::size_t i{};
+                bool const  fixed = ([&] {
+                    if(packed_width[i++] != 0) { return true; }
+                    auto const s = detail::fixed_size<Ms, Size_t>();
+                    if(s) { size += *s; }
+                    return s.has_value();
+                }() && ...);
+                if(!fixed) { return std::nullopt; }
+                return size;
+            } else {
+                return detail::fixed_size_sum<Size_t, Ms...>();
+            }
+        }(detail::member_types_t<T>{});
+
+    template<typename Buffer>
+    static constexpr bool serialize(T const& v,
+                                    Buffer&  buffer) {
+        if constexpr(detail::memcpyable<T, Size_t>) {
+            return buffer.insert(std::as_bytes(std::span{std::addressof(v), 1}));
+        } else if constexpr(prefixed) {
+            return with_defaults(v, [&](T const& defaults) {
+                return serialize_prefixed(v, defaults, buffer);
+            });
+        } else {
+            auto const tie = glz::to_tie(v);
+            return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                using std::get;
+                return (serializer<std::remove_cvref_t<decltype(get<Is>(tie))>, Size_t>::serialize(
+                          get<Is>(tie),
+                          buffer)
+                        && ...);
+            }(std::make_index_sequence<glz::reflect<T>::size>{});
+        }
+    }
+
+    template<typename Buffer>
+    static constexpr bool deserialize(T&      v,
+                                      Buffer& buffer) {
+        if constexpr(detail::memcpyable<T, Size_t>) {
+            return buffer.extract(std::as_writable_bytes(std::span{std::addressof(v), 1}));
+        } else if constexpr(prefixed) {
+            if constexpr(compact) {
+                return with_defaults(v, [&](T const& defaults) {
+                    return deserialize_prefixed(v, defaults, buffer);
+                });
+            } else {
+                // the defaults are never read, v only stands in for them
+                return deserialize_prefixed(v, v, buffer);
+            }
+        } else {
+            auto tie = glz::to_tie(v);
+            return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                using std::get;
+                return (serializer<std::remove_cvref_t<decltype(get<Is>(tie))>,
+                                   Size_t>::deserialize(get<Is>(tie), buffer)
+                        && ...);
+            }(std::make_index_sequence<glz::reflect<T>::size>{});
+        }
+    }
 };
 
 template<typename T, typename Size_t>
@@ -138,52 +1018,78 @@ struct serializer<std::optional<T>, Size_t> {
 
 template<typename... Ts, typename Size_t>
 struct serializer<std::variant<Ts...>, Size_t> {
+    static constexpr std::size_t N{sizeof...(Ts)};
+    using size_type = detail::size_type_t<Size_t>;
+    using Index_t   = std::conditional_t<detail::policy<Size_t>::varint_sizes
+                                         || (N > std::numeric_limits<std::uint8_t>::max()),
+                                       size_type,
+                                       std::uint8_t>;
+    static_assert(std::numeric_limits<Index_t>::max() >= N, "variant to big");
+
+private:
+    template<std::size_t I>
+    using alternative_t = std::variant_alternative_t<I, std::variant<Ts...>>;
+
+    template<std::size_t I,
+             typename Buffer>
+    static constexpr bool serialize_alternative(std::variant<Ts...> const& v,
+                                                Buffer&                    buffer) {
+        return serializer<alternative_t<I>, Size_t>::serialize(*std::get_if<I>(&v), buffer);
+    }
+
+    template<std::size_t I,
+             typename Buffer>
+    static constexpr bool deserialize_alternative(std::variant<Ts...>& v,
+                                                  Buffer&              buffer) {
+        return serializer<alternative_t<I>, Size_t>::deserialize(v.template emplace<I>(), buffer);
+    }
+
+    // One entry per alternative, indexed by the alternative index, so that dispatch does not
+    // depend on the number of alternatives
+    template<typename Buffer>
+    static constexpr auto serializers = []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return std::array{&serialize_alternative<Is, Buffer>...};
+    }(std::make_index_sequence<N>{});
+
+    template<typename Buffer>
+    static constexpr auto deserializers = []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return std::array{&deserialize_alternative<Is, Buffer>...};
+    }(std::make_index_sequence<N>{});
+
+public:
     template<typename Buffer>
     static constexpr bool serialize(std::variant<Ts...> const& v,
                                     Buffer&                    buffer) {
-        constexpr std::size_t N{sizeof...(Ts)};
-        using Index_t = std::
-          conditional_t<(N > std::numeric_limits<std::uint8_t>::max()), Size_t, std::uint8_t>;
-        static_assert(std::numeric_limits<Index_t>::max() >= N, "variant to big");
+        if(v.valueless_by_exception()) { return false; }
         Index_t const index = static_cast<Index_t>(v.index());
-        if(!serializer<Index_t, Size_t>::serialize(index, buffer)) { return false; }
-        return std::visit(
-          [&](auto const& vv) {
-              return serializer<std::remove_cvref_t<decltype(vv)>, Size_t>::serialize(vv, buffer);
-          },
-          v);
+        if constexpr(detail::policy<Size_t>::varint_sizes) {
+            if(!detail::serialize_size<Size_t>(index, buffer)) { return false; }
+        } else {
+            if(!detail::serialize_fixed<Size_t>(index, buffer)) { return false; }
+        }
+        return serializers<Buffer>[index](v, buffer);
     }
 
     template<typename Buffer>
     static constexpr bool deserialize(std::variant<Ts...>& v,
                                       Buffer&              buffer) {
-        constexpr std::size_t N{sizeof...(Ts)};
-        using Index_t = std::
-          conditional_t<(N > std::numeric_limits<std::uint8_t>::max()), Size_t, std::uint8_t>;
-        static_assert(std::numeric_limits<Index_t>::max() >= N, "variant to big");
         Index_t index{};
 
-        if(!serializer<Index_t, Size_t>::deserialize(index, buffer)) { return false; }
+        if constexpr(detail::policy<Size_t>::varint_sizes) {
+            if(!detail::deserialize_size<Size_t>(index, buffer)) { return false; }
+        } else {
+            if(!detail::deserialize_fixed<Size_t>(index, buffer)) { return false; }
+        }
         if(index >= N) { return false; }
 
-        auto action = [&](auto i) {
-            static constexpr std::size_t I = decltype(i)::value;
-            if(I == index) {
-                v.template emplace<I>();
-                return serializer<std::variant_alternative_t<I, std::variant<Ts...>>,
-                                  Size_t>::deserialize(std::get<I>(v), buffer);
-            }
-            return N > I;
-        };
-
-        return [&]<std::size_t... Ns>(std::index_sequence<Ns...>) {
-            return (action(std::integral_constant<std::size_t, Ns>{}) && ...);
-        }(std::make_index_sequence<N>{});
+        return deserializers<Buffer>[index](v, buffer);
     }
 };
 
 template<typename Rep, typename Period, typename Size_t>
 struct serializer<std::chrono::duration<Rep, Period>, Size_t> {
+    static constexpr std::optional<std::size_t> fixed_size = detail::fixed_size<Rep, Size_t>();
+
     template<typename Buffer>
     static constexpr bool serialize(std::chrono::duration<Rep,
                                                           Period> const& v,
@@ -202,15 +1108,23 @@ struct serializer<std::chrono::duration<Rep, Period>, Size_t> {
     }
 };
 
+// Elements may be references, std::tuple<int const&, T const&> serializes like std::tuple<int, T>
 template<detail::is_tuple_like_but_not_range T, typename Size_t>
 struct serializer<T, Size_t> {
+    template<std::size_t I>
+    using element_t = std::remove_cvref_t<std::tuple_element_t<I, T>>;
+
+    static constexpr std::optional<std::size_t> fixed_size
+      = []<std::size_t... Is>(std::index_sequence<Is...>) {
+            return detail::fixed_size_sum<Size_t, element_t<Is>...>();
+        }(std::make_index_sequence<std::tuple_size_v<T>>{});
+
     template<typename Buffer>
     static constexpr bool serialize(T const& v,
                                     Buffer&  buffer) {
         return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
             using std::get;
-            return (serializer<std::tuple_element_t<Is, T>, Size_t>::serialize(get<Is>(v), buffer)
-                    && ...);
+            return (serializer<element_t<Is>, Size_t>::serialize(get<Is>(v), buffer) && ...);
         }(std::make_index_sequence<std::tuple_size_v<T>>{});
     }
 
@@ -219,8 +1133,7 @@ struct serializer<T, Size_t> {
                                       Buffer& buffer) {
         return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
             using std::get;
-            return (serializer<std::tuple_element_t<Is, T>, Size_t>::deserialize(get<Is>(v), buffer)
-                    && ...);
+            return (serializer<element_t<Is>, Size_t>::deserialize(get<Is>(v), buffer) && ...);
         }(std::make_index_sequence<std::tuple_size_v<T>>{});
     }
 };
@@ -229,27 +1142,58 @@ template<std::ranges::range T, typename Size_t>
 struct serializer<T, Size_t> {
     static constexpr bool is_contiguous = std::ranges::contiguous_range<T>;
     using value_t                       = std::ranges::range_value_t<T>;
-    static constexpr bool is_trivial    = detail::trivial<value_t>;
+    static constexpr bool is_trivial    = detail::memcpyable<value_t, Size_t>;
+    static constexpr bool is_varint     = detail::varint_integer<value_t, Size_t>;
+    static constexpr bool is_swapped    = detail::swapped<value_t, Size_t> && !is_varint;
+    static constexpr bool is_columnar   = detail::policy<Size_t>::columnar && Described<value_t>
+                                     && !std::ranges::range<value_t> && !detail::is_map<T>
+                                     && !detail::is_set<T>;
+    using size_type                     = detail::size_type_t<Size_t>;
+
+    static constexpr std::optional<std::size_t> fixed_size = []() -> std::optional<std::size_t> {
+        if constexpr(detail::is_tuple_like<T> && is_columnar) {
+            auto const columns_size = detail::columns_size<value_t, Size_t>(std::tuple_size_v<T>);
+            if(columns_size) {
+                return detail::size_size<Size_t>(std::tuple_size_v<T>) + *columns_size;
+            }
+        } else if constexpr(detail::is_tuple_like<T>) {
+            auto const value_size = detail::fixed_size<value_t, Size_t>();
+            if(value_size) {
+                return detail::size_size<Size_t>(std::tuple_size_v<T>)
+                     + (*value_size * std::tuple_size_v<T>);
+            }
+        }
+        return std::nullopt;
+    }();
 
     template<typename Buffer>
     static constexpr bool serialize(T const& v,
                                     Buffer&  buffer) {
         auto const full_size = std::ranges::size(v);
         // Check for overflow when Size_t is smaller than the range's size type
-        if constexpr(std::numeric_limits<Size_t>::max()
+        if constexpr(std::numeric_limits<size_type>::max()
                      < std::numeric_limits<decltype(full_size)>::max())
         {
-            if(full_size > std::numeric_limits<Size_t>::max()) {
+            if(full_size > std::numeric_limits<size_type>::max()) {
                 return false;   // Size exceeds Size_t capacity
             }
         }
-        auto const size = static_cast<Size_t>(full_size);
+        auto const size = static_cast<size_type>(full_size);
 
-        if(!serializer<Size_t, Size_t>::serialize(size, buffer)) { return false; }
+        if(!detail::serialize_size<Size_t>(size, buffer)) { return false; }
 
-        if constexpr(is_contiguous && is_trivial) {
-            return buffer.insert(std::as_bytes(std::span{v}));
+        if constexpr(is_columnar) {
+            return serialize_columns(v, full_size, buffer);
+        } else if constexpr(is_contiguous && is_trivial) {
+            return detail::insert_ref(std::as_bytes(std::span{v}), buffer);
+        } else if constexpr(is_varint) {
+            return detail::serialize_varints(v, buffer);
         } else {
+            if constexpr(is_contiguous && is_swapped) {
+                if(!std::is_constant_evaluated()) {
+                    return detail::serialize_swapped<Size_t>(v, buffer);
+                }
+            }
             for(auto const& vv : v) {
                 if(!serializer<value_t, Size_t>::serialize(vv, buffer)) { return false; }
             }
@@ -260,10 +1204,12 @@ struct serializer<T, Size_t> {
     template<typename Buffer>
     static constexpr bool deserialize(T&      v,
                                       Buffer& buffer) {
-        Size_t size{};
-        if(!serializer<Size_t, Size_t>::deserialize(size, buffer)) { return false; }
+        size_type size{};
+        if(!detail::deserialize_size<Size_t>(size, buffer)) { return false; }
         if(size > buffer.size()) { return false; }
 
+        if(!std::is_constant_evaluated()) { detail::adopt_resource(v, buffer); }
+
         if constexpr(requires { v.resize(size); }) { v.resize(size); }
 
         if constexpr(detail::is_map<T> || detail::is_set<T>) {
@@ -272,18 +1218,35 @@ struct serializer<T, Size_t> {
             if(std::ranges::size(v) != size) { return false; }
         }
 
-        if constexpr(is_contiguous && is_trivial) {
+        if constexpr(is_columnar) {
+            return deserialize_columns(v, size, buffer);
+        } else if constexpr(is_contiguous && is_trivial) {
             return buffer.extract(std::as_writable_bytes(std::span{v}));
         } else {
-            if constexpr(detail::is_map<T> || detail::is_set<T>) {
-                while(size != 0) {
-                    --size;
-                    using value_type = typename detail::associative_container_value_type<T>::type;
-
-                    value_type vv;
-                    if(!serializer<value_type, Size_t>::deserialize(vv, buffer)) { return false; }
-                    v.insert(vv);
+            if constexpr(is_contiguous && is_swapped) {
+                if(!std::is_constant_evaluated()) {
+                    auto const bytes = std::as_writable_bytes(std::span{v});
+                    if(!buffer.extract(bytes)) { return false; }
+                    detail::byteswap_elements<sizeof(value_t)>(bytes);
+                    return true;
+                }
+            }
+            if constexpr(is_contiguous && is_varint
+                         && requires {
+                                buffer.span();
+                                buffer.skip(std::size_t{});
+                            })
+            {
+                if(!std::is_constant_evaluated()) {
+                    auto const consumed = detail::decode_varints(buffer.span(),
+                                                                 std::span<value_t>{v});
+                    if(!consumed) { return false; }
+                    buffer.skip(*consumed);
+                    return true;
                 }
+            }
+            if constexpr(detail::is_map<T> || detail::is_set<T>) {
+                return deserialize_associative(v, size, buffer);
             } else {
                 for(auto& vv : v) {
                     if(!serializer<value_t, Size_t>::deserialize(vv, buffer)) { return false; }
@@ -292,10 +1255,297 @@ struct serializer<T, Size_t> {
             return true;
         }
     }
+
+    // Member I of every element into column, a resizable range of the member's type. The
+    // other columns are skipped, buffer ends up after the range like with deserialize.
+    template<std::size_t I,
+             typename Column,
+             typename Buffer>
+        requires is_columnar
+    static constexpr bool deserialize_column(Column& column,
+                                             Buffer& buffer) {
+        static_assert(I < glz::reflect<value_t>::size, "no member with this index");
+        size_type size{};
+        if(!detail::deserialize_size<Size_t>(size, buffer)) { return false; }
+        if(size > buffer.size()) { return false; }
+
+        auto const count = static_cast<std::size_t>(size);
+        if constexpr(requires { column.resize(count); }) { column.resize(count); }
+        if(std::ranges::size(column) != count) { return false; }
+
+        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            return ([&] {
+                using M = detail::member_type_t<value_t, Is>;
+                if constexpr(Is == I) {
+                    return detail::deserialize_column<M, Size_t>(column, count, buffer);
+                } else {
+                    return detail::skip_column<M, Size_t>(count, buffer);
+                }
+            }() && ...);
+        }(std::make_index_sequence<glz::reflect<value_t>::size>{});
+    }
+
+private:
+    template<std::size_t I>
+    static constexpr auto member = [](auto& row) -> auto& {
+        auto tie = glz::to_tie(row);
+        using std::get;
+        return get<I>(tie);
+    };
+
+    template<typename Buffer>
+    static constexpr bool serialize_columns(T const&    v,
+                                            std::size_t count,
+                                            Buffer&     buffer) {
+        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            return (detail::serialize_column<detail::member_type_t<value_t, Is>, Size_t>(
+                      std::views::transform(v, member<Is>),
+                      count,
+                      buffer)
+                    && ...);
+        }(std::make_index_sequence<glz::reflect<value_t>::size>{});
+    }
+
+    template<typename Buffer>
+    static constexpr bool deserialize_columns(T&          v,
+                                              std::size_t count,
+                                              Buffer&     buffer) {
+        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            return (detail::deserialize_column<detail::member_type_t<value_t, Is>, Size_t>(
+                      std::views::transform(v, member<Is>),
+                      count,
+                      buffer)
+                    && ...);
+        }(std::make_index_sequence<glz::reflect<value_t>::size>{});
+    }
+
+    // Sorted containers are written in order, so inserting every element at the end is right
+    // unless the input was produced by something else.
+    template<typename Buffer>
+    static constexpr bool deserialize_associative(T&        v,
+                                                  size_type size,
+                                                  Buffer&   buffer) {
+        if constexpr(detail::is_flat_map<T> || detail::is_flat_set<T>) {
+            return deserialize_flat(v, size, buffer);
+        } else {
+            using value_type = typename detail::associative_container_value_type<T>::type;
+            if constexpr(requires { v.reserve(std::size_t{}); }) { v.reserve(size); }
+            for(; size != 0; --size) {
+                auto vv = detail::make_element<value_type>(v);
+                if(!serializer<value_type, Size_t>::deserialize(vv, buffer)) { return false; }
+                v.emplace_hint(v.end(), std::move(vv));
+            }
+            return true;
+        }
+    }
+
+    // Flat containers are filled through their underlying containers and adopt them as they
+    // are when the keys are already strictly ordered, otherwise the constructor sorts them.
+    template<typename Buffer>
+    static constexpr bool deserialize_flat(T&        v,
+                                           size_type size,
+                                           Buffer&   buffer) {
+        auto const comp    = v.key_comp();
+        auto const ordered = [&](auto const& keys) {
+            return std::ranges::adjacent_find(keys, [&](auto const& a, auto const& b) {
+                       return !comp(a, b);
+                   })
+                == keys.end();
+        };
+        if constexpr(detail::is_flat_map<T>) {
+            using key_type    = typename T::key_type;
+            using mapped_type = typename T::mapped_type;
+
+            auto containers = std::move(v).extract();
+            containers.keys.clear();
+            containers.values.clear();
+            if constexpr(requires { containers.keys.reserve(std::size_t{}); }) {
+                containers.keys.reserve(size);
+            }
+            if constexpr(requires { containers.values.reserve(std::size_t{}); }) {
+                containers.values.reserve(size);
+            }
+            for(; size != 0; --size) {
+                auto& key   = containers.keys.emplace_back();
+                auto& value = containers.values.emplace_back();
+                if(!serializer<key_type, Size_t>::deserialize(key, buffer)
+                   || !serializer<mapped_type, Size_t>::deserialize(value, buffer))
+                {
+                    return false;
+                }
+            }
+            if(ordered(containers.keys)) {
+                v.replace(std::move(containers.keys), std::move(containers.values));
+            } else {
+                v = T(std::move(containers.keys), std::move(containers.values), comp);
+            }
+        } else {
+            using key_type = typename T::key_type;
+
+            auto keys = std::move(v).extract();
+            keys.clear();
+            if constexpr(requires { keys.reserve(std::size_t{}); }) { keys.reserve(size); }
+            for(; size != 0; --size) {
+                if(!serializer<key_type, Size_t>::deserialize(keys.emplace_back(), buffer)) {
+                    return false;
+                }
+            }
+            if(ordered(keys)) {
+                v.replace(std::move(keys));
+            } else {
+                v = T(std::move(keys), comp);
+            }
+        }
+        return true;
+    }
+};
+
+// One bit per element instead of one byte, only with BitPacked
+template<typename Allocator, typename Size_t>
+    requires detail::policy<Size_t>::bit_packed
+struct serializer<std::vector<bool, Allocator>, Size_t> {
+    using size_type = detail::size_type_t<Size_t>;
+
+    template<typename Buffer>
+    static constexpr bool serialize(std::vector<bool, Allocator> const& v,
+                                    Buffer&                             buffer) {
+        if constexpr(std::numeric_limits<size_type>::max()
+                     < std::numeric_limits<std::size_t>::max())
+        {
+            if(v.size() > std::numeric_limits<size_type>::max()) { return false; }
+        }
+        if(!detail::serialize_size<Size_t>(static_cast<size_type>(v.size()), buffer)) {
+            return false;
+        }
+        return detail::serialize_bits(v.size(), [&](std::size_t i) { return v[i]; }, buffer);
+    }
+
+    template<typename Buffer>
+    static constexpr bool deserialize(std::vector<bool, Allocator>& v,
+                                      Buffer&                       buffer) {
+        size_type size{};
+        if(!detail::deserialize_size<Size_t>(size, buffer)) { return false; }
+        auto const count = static_cast<std::size_t>(size);
+        if((count + 7) / 8 > buffer.size()) { return false; }
+        v.resize(count);
+        return detail::deserialize_bits(
+          count,
+          [&](std::size_t i, bool bit) { v[i] = bit; },
+          buffer);
+    }
+};
+
+template<std::size_t N, typename Size_t>
+struct serializer<std::bitset<N>, Size_t> {
+    static constexpr std::optional<std::size_t> fixed_size{(N + 7) / 8};
+
+    template<typename Buffer>
+    static constexpr bool serialize(std::bitset<N> const& v,
+                                    Buffer&               buffer) {
+        return detail::serialize_bits(N, [&](std::size_t i) { return v[i]; }, buffer);
+    }
+
+    template<typename Buffer>
+    static constexpr bool deserialize(std::bitset<N>& v,
+                                      Buffer&         buffer) {
+        return detail::deserialize_bits(
+          N,
+          [&](std::size_t i, bool bit) { v[i] = bit; },
+          buffer);
+    }
+};
+
+// Zero-copy: the deserialized view points into the buffer and is only valid as long as it is.
+// Where the elements land in the buffer depends on everything written before them, so only
+// views of byte sized elements can be read, wider ones are read into a std::vector instead.
+template<typename T, typename Size_t>
+    requires detail::memcpyable<T, Size_t>
+struct serializer<std::span<T const>, Size_t> {
+    using size_type = detail::size_type_t<Size_t>;
+
+    template<typename Buffer>
+    static constexpr bool serialize(std::span<T const> const& v,
+                                    Buffer&                   buffer) {
+        if constexpr(std::numeric_limits<size_type>::max()
+                     < std::numeric_limits<std::size_t>::max())
+        {
+            if(v.size() > std::numeric_limits<size_type>::max()) { return false; }
+        }
+        if(!detail::serialize_size<Size_t>(static_cast<size_type>(v.size()), buffer)) {
+            return false;
+        }
+        return detail::insert_ref(std::as_bytes(v), buffer);
+    }
+
+    template<typename Buffer>
+    static constexpr bool deserialize(std::span<T const>& v,
+                                      Buffer&             buffer) {
+        static_assert(requires {
+            buffer.span();
+            buffer.skip(std::size_t{});
+        }, "zero-copy deserialization needs a view with span() and skip()");
+        static_assert(alignof(T) == 1,
+                      "elements of zero-copy views can not be aligned in the buffer, "
+                      "deserialize into a std::vector instead");
+
+        size_type size{};
+        if(!detail::deserialize_size<Size_t>(size, buffer)) { return false; }
+
+        auto const bytes = buffer.span();
+        if(size > bytes.size() / sizeof(T)) { return false; }
+        if(size == 0) {
+            v = {};
+            return true;
+        }
+
+#if defined(__cpp_lib_start_lifetime_as)
+        v = std::span{std::start_lifetime_as_array<T>(bytes.data(), size), size};
+#else
+        v = std::span{reinterpret_cast<T const*>(bytes.data()), size};
+#endif
+        buffer.skip(size * sizeof(T));
+        return true;
+    }
+};
+
+template<typename CharT, typename Traits, typename Size_t>
+struct serializer<std::basic_string_view<CharT, Traits>, Size_t> {
+    using span_serializer = serializer<std::span<CharT const>, Size_t>;
+
+    template<typename Buffer>
+    static constexpr bool serialize(std::basic_string_view<CharT, Traits> const& v,
+                                    Buffer&                                      buffer) {
+        return span_serializer::serialize(std::span{v}, buffer);
+    }
+
+    template<typename Buffer>
+    static constexpr bool deserialize(std::basic_string_view<CharT, Traits>& v,
+                                      Buffer&                                buffer) {
+        std::span<CharT const> vv{};
+        if(!span_serializer::deserialize(vv, buffer)) { return false; }
+        v = std::basic_string_view<CharT, Traits>{vv.data(), vv.size()};
+        return true;
+    }
 };
 
 template<typename Size_t>
 struct Serializer {
+    template<typename... Ts>
+    static constexpr std::optional<std::size_t> fixed_size
+      = detail::fixed_size_sum<Size_t, std::remove_cvref_t<Ts>...>();
+
+    // Bytes serialize would write, std::nullopt if it would fail
+    template<typename... Ts>
+    static constexpr std::optional<std::size_t> serialized_size(Ts const&... vs) {
+        if constexpr(fixed_size<Ts...>.has_value()) {
+            return *fixed_size<Ts...>;
+        } else {
+            CountingSerializationView buffer{};
+            if(!serialize(buffer, vs...)) { return std::nullopt; }
+            return buffer.size();
+        }
+    }
+
     template<typename Buffer,
              typename... Ts>
     static constexpr bool serialize(Buffer& buffer,
@@ -310,6 +1560,17 @@ struct Serializer {
         return (serializer<std::remove_cvref_t<Ts>, Size_t>::deserialize(vs, buffer) && ...);
     }
 
+    // Member I of every element of a range T of Described structs written with Columnar
+    template<typename T,
+             std::size_t I,
+             typename Buffer,
+             typename Column>
+    static constexpr bool deserialize_column(Buffer& buffer,
+                                             Column& column) {
+        return serializer<std::remove_cvref_t<T>, Size_t>::template deserialize_column<I>(column,
+                                                                                          buffer);
+    }
+
     template<typename T,
              typename Buffer>
     static constexpr std::optional<T> deserialize(Buffer& buffer) {
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+namespace aglio::detail {
+
+template<std::unsigned_integral T>
+inline constexpr std::size_t varint_max_size{(std::numeric_limits<T>::digits + 6) / 7};
+
+template<std::unsigned_integral T>
+constexpr std::size_t varint_size(T v) {
+    return v == 0 ? 1 : (static_cast<std::size_t>(std::bit_width(v)) + 6) / 7;
+}
+
+template<std::unsigned_integral T>
+constexpr std::size_t encode_varint(T                                        v,
+                                    std::span<std::byte, varint_max_size<T>> out) {
+    std::size_t pos{};
+    while(v >= 0x80) {
+        out[pos++] = static_cast<std::byte>(static_cast<std::uint8_t>(v) | 0x80);
+        v          = static_cast<T>(v >> 7);
+    }
+    out[pos++] = static_cast<std::byte>(v);
+    return pos;
+}
+
+// Decodes up to 8 bytes without a loop: the terminating byte is the first one with a clear
+// high bit, everything above it is masked off and the 7 bit groups are compacted pairwise.
+// Returns the number of consumed bytes or 0 if the varint is longer than 8 bytes.
+constexpr std::size_t decode_varint_word(std::uint64_t  word,
+                                         std::uint64_t& value) {
+    std::uint64_t const stops = ~word & 0x8080'8080'8080'8080;
+    if(stops == 0) { return 0; }
+    std::uint64_t x = word & (stops ^ (stops - 1)) & 0x7F7F'7F7F'7F7F'7F7F;
+    x               = ((x & 0x7F00'7F00'7F00'7F00) >> 1) | (x & 0x007F'007F'007F'007F);
+    x               = ((x & 0x3FFF'0000'3FFF'0000) >> 2) | (x & 0x0000'3FFF'0000'3FFF);
+    x               = ((x & 0x0FFF'FFFF'0000'0000) >> 4) | (x & 0x0000'0000'0FFF'FFFF);
+    value           = x;
+    return (static_cast<std::size_t>(std::countr_zero(stops)) / 8) + 1;
+}
+
+template<std::integral T>
+constexpr std::make_unsigned_t<T> zigzag_encode(T v) {
+    using U = std::make_unsigned_t<T>;
+    if constexpr(std::is_signed_v<T>) {
+        return static_cast<U>(static_cast<U>(static_cast<U>(v) << 1)
+                              ^ static_cast<U>(v >> std::numeric_limits<T>::digits));
+    } else {
+        return v;
+    }
+}
+
+template<std::integral T>
+constexpr T zigzag_decode(std::make_unsigned_t<T> v) {
+    using U = std::make_unsigned_t<T>;
+    if constexpr(std::is_signed_v<T>) {
+        return static_cast<T>(static_cast<U>(v >> 1) ^ static_cast<U>(-static_cast<U>(v & 1U)));
+    } else {
+        return v;
+    }
+}
+
+template<std::unsigned_integral T>
+constexpr std::size_t decode_varint(std::span<std::byte const> in,
+                                    T&                         v) {
+    T value{};
+    for(std::size_t i = 0; i < varint_max_size<T> && i < in.size(); ++i) {
+        auto const bits  = static_cast<T>(in[i] & std::byte{0x7F});
+        auto const shift = 7 * i;
+        if(static_cast<T>(static_cast<T>(bits << shift) >> shift) != bits) { return 0; }
+        value = static_cast<T>(value | static_cast<T>(bits << shift));
+        if((in[i] & std::byte{0x80}) == std::byte{0}) {
+            v = value;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+template<std::unsigned_integral T,
+         typename Buffer>
+constexpr bool serialize_varint(T       v,
+                                Buffer& buffer) {
+    std::array<std::byte, varint_max_size<T>> bytes{};
+    auto const                                size = encode_varint(v, std::span{bytes});
+    return buffer.insert(std::span{bytes}.first(size));
+}
+
+template<std::unsigned_integral T,
+         typename Buffer>
+constexpr bool deserialize_varint(T&      v,
+                                  Buffer& buffer) {
+    if constexpr(std::endian::native == std::endian::little
+                 && requires {
+                        buffer.span();
+                        buffer.skip(std::size_t{});
+                    })
+    {
+        if(!std::is_constant_evaluated()) {
+            auto const in = buffer.span();
+            if(in.size() >= sizeof(std::uint64_t)) {
+                std::uint64_t word{};
+                std::memcpy(std::addressof(word), in.data(), sizeof(word));
+                std::uint64_t value{};
+                auto const    size = decode_varint_word(word, value);
+                if(size != 0) {
+                    if(size > varint_max_size<T> || value > std::numeric_limits<T>::max()) {
+                        return false;
+                    }
+                    v = static_cast<T>(value);
+                    buffer.skip(size);
+                    return true;
+                }
+            }
+        }
+    }
+
+    T value{};
+    for(std::size_t i = 0; i < varint_max_size<T>; ++i) {
+        std::byte b{};
+        if(!buffer.extract(std::span{std::addressof(b), 1})) { return false; }
+        auto const bits  = static_cast<T>(b & std::byte{0x7F});
+        auto const shift = 7 * i;
+        if(static_cast<T>(static_cast<T>(bits << shift) >> shift) != bits) { return false; }
+        value = static_cast<T>(value | static_cast<T>(bits << shift));
+        if((b & std::byte{0x80}) == std::byte{0}) {
+            v = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<std::ranges::input_range R,
+         typename Buffer>
+constexpr bool serialize_varints(R const& values,
+                                 Buffer&  buffer) {
+    using T = std::make_unsigned_t<std::ranges::range_value_t<R>>;
+    std::array<std::byte, 512> block{};
+    std::size_t                used{};
+    for(auto const& v : values) {
+        if(used + varint_max_size<T> > block.size()) {
+            if(!buffer.insert(std::span{block}.first(used))) { return false; }
+            used = 0;
+        }
+        used += encode_varint(zigzag_encode(v),
+                              std::span{block}.subspan(used).template first<varint_max_size<T>>());
+    }
+    return buffer.insert(std::span{block}.first(used));
+}
+
+// Decodes out.size() zigzag varints from in and returns the number of consumed bytes.
+// Runs of single byte values are detected 16 (SSE2) or 8 (SWAR) bytes at a time.
+template<std::integral T>
+inline std::optional<std::size_t> decode_varints(std::span<std::byte const> in,
+                                                 std::span<T>               out) {
+    using U = std::make_unsigned_t<T>;
+    std::size_t pos{};
+    std::size_t i{};
+    while(i != out.size()) {
+#if defined(__SSE2__)
+        while(out.size() - i >= 16 && in.size() - pos >= 16) {
+            __m128i const bytes
+              = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in.subspan(pos).data()));
+            if(_mm_movemask_epi8(bytes) != 0) { break; }
+            for(std::size_t k = 0; k != 16; ++k) {
+                out[i + k] = zigzag_decode<T>(static_cast<U>(in[pos + k]));
+            }
+            i += 16;
+            pos += 16;
+        }
+        if(i == out.size()) { break; }
+#endif
+        if constexpr(std::endian::native == std::endian::little) {
+            if(in.size() - pos >= sizeof(std::uint64_t)) {
+                std::uint64_t word{};
+                std::memcpy(std::addressof(word), in.subspan(pos).data(), sizeof(word));
+                if((word & 0x8080'8080'8080'8080) == 0 && out.size() - i >= 8) {
+                    for(std::size_t k = 0; k != 8; ++k) {
+                        out[i + k] = zigzag_decode<T>(static_cast<U>((word >> (8 * k)) & 0x7F));
+                    }
+                    i += 8;
+                    pos += 8;
+                    continue;
+                }
+                std::uint64_t value{};
+                auto const    size = decode_varint_word(word, value);
+                if(size != 0) {
+                    if(size > varint_max_size<U> || value > std::numeric_limits<U>::max()) {
+                        return std::nullopt;
+                    }
+                    out[i++] = zigzag_decode<T>(static_cast<U>(value));
+                    pos += size;
+                    continue;
+                }
+            }
+        }
+        U          value{};
+        auto const size = decode_varint(in.subspan(pos), value);
+        if(size == 0) { return std::nullopt; }
+        out[i++] = zigzag_decode<T>(value);
+        pos += size;
+    }
+    return pos;
+}
+
+}   // namespace aglio::detail
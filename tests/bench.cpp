@@ -0,0 +1,244 @@
+#include "bench.hpp"
+#include "types.hpp"
+
+#include <aglio/serialization_buffers.hpp>
+#include <aglio/serializer.hpp>
+#include <fmt/format.h>
+#include <glaze/beve.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Throughput of serialize and deserialize for every type family of the tests, every view and
+// every Size_t policy, with glaze BEVE as baseline. One JSON object per line on stdout:
+//
+//   aglio_bench [filter=<substring>] [min_time_ms=<ms>]
+//
+// filter matches "<op>/<library>/<type>/<view>/<size_t>", for example filter=Nested.
+
+namespace {
+
+template<typename T>
+struct Named;
+
+template<>
+struct Named<Types::Primitive> {
+    static constexpr std::string_view name{"Primitive"};
+};
+
+template<>
+struct Named<Types::Container> {
+    static constexpr std::string_view name{"Container"};
+};
+
+template<>
+struct Named<Types::Associative> {
+    static constexpr std::string_view name{"Associative"};
+};
+
+template<>
+struct Named<Types::Wrapper> {
+    static constexpr std::string_view name{"Wrapper"};
+};
+
+template<>
+struct Named<Types::Chrono> {
+    static constexpr std::string_view name{"Chrono"};
+};
+
+template<>
+struct Named<Types::Nested> {
+    static constexpr std::string_view name{"Nested"};
+};
+
+template<>
+struct Named<Types::Enum> {
+    static constexpr std::string_view name{"Enum"};
+};
+
+template<>
+struct Named<std::uint16_t> {
+    static constexpr std::string_view name{"uint16_t"};
+};
+
+template<>
+struct Named<std::uint32_t> {
+    static constexpr std::string_view name{"uint32_t"};
+};
+
+template<>
+struct Named<aglio::Varint<std::uint32_t>> {
+    static constexpr std::string_view name{"Varint<uint32_t>"};
+};
+
+template<>
+struct Named<aglio::VarintIntegers<std::uint16_t>> {
+    static constexpr std::string_view name{"VarintIntegers<uint16_t>"};
+};
+
+template<>
+struct Named<aglio::BigEndian<std::uint32_t>> {
+    static constexpr std::string_view name{"BigEndian<uint32_t>"};
+};
+
+using SizesList = std::tuple<std::uint16_t,
+                             std::uint32_t,
+                             aglio::Varint<std::uint32_t>,
+                             aglio::VarintIntegers<std::uint16_t>,
+                             aglio::BigEndian<std::uint32_t>>;
+
+using Test::bench::escape;
+
+// One JSON object per measurement
+void report(Test::bench::Runner& runner,
+            std::string_view     op,
+            std::string_view     library,
+            std::string_view     type,
+            std::string_view     view,
+            std::string_view     size_t_name,
+            std::size_t          bytes,
+            auto&&               f) {
+    auto const name = fmt::format("{}/{}/{}/{}/{}", op, library, type, view, size_t_name);
+    auto const m    = runner.measure(name, f);
+    if(!m) { return; }
+    fmt::print(R"({{"op":"{}","library":"{}","type":"{}","view":"{}","size_t":"{}",)"
+               R"("bytes":{},"iterations":{},"ns_per_op":{:.2f},"mb_per_s":{:.2f}}})"
+               "\n",
+               op,
+               library,
+               type,
+               view,
+               size_t_name,
+               bytes,
+               m->iterations,
+               m->ns_per_op,
+               Test::bench::mb_per_s(bytes, *m));
+}
+
+template<typename Type,
+         typename Size_t>
+void bench_aglio(Test::bench::Runner& runner) {
+    using Serializer = aglio::Serializer<Size_t>;
+    auto const type  = Named<Type>::name;
+    auto const sizes = Named<Size_t>::name;
+
+    Type const             value = Types::createDefault<Type>();
+    std::vector<std::byte> encoded{};
+    {
+        aglio::DynamicSerializationView view{encoded};
+        if(!Serializer::serialize(view, value)) {
+            runner.failed = true;
+            return;
+        }
+    }
+    auto const bytes = encoded.size();
+
+    std::vector<std::byte> buffer{};
+    report(runner, "serialize", "aglio", type, "dynamic", sizes, bytes, [&] {
+        buffer.clear();
+        aglio::DynamicSerializationView view{buffer};
+        bool const                      ok = Serializer::serialize(view, value);
+        escape(buffer);
+        return ok;
+    });
+
+    std::stringstream stream{};
+    report(runner, "serialize", "aglio", type, "stream", sizes, bytes, [&] {
+        stream.seekp(0);
+        aglio::StreamSerializationView view{stream};
+        bool const                     ok = Serializer::serialize(view, value);
+        escape(stream);
+        return ok;
+    });
+
+    report(runner, "serialize", "aglio", type, "buffered_stream", sizes, bytes, [&] {
+        stream.seekp(0);
+        aglio::BufferedStreamSerializationView view{stream};
+        bool const                             ok = Serializer::serialize(view, value);
+        return ok && view.flush();
+    });
+
+    Type out{};
+    report(runner, "deserialize", "aglio", type, "dynamic", sizes, bytes, [&] {
+        aglio::DynamicDeserializationView view{encoded};
+        bool const                        ok = Serializer::deserialize(view, out);
+        escape(out);
+        return ok;
+    });
+
+    stream.str(std::string(reinterpret_cast<char const*>(encoded.data()), encoded.size()));
+    report(runner, "deserialize", "aglio", type, "stream", sizes, bytes, [&] {
+        stream.clear();
+        stream.seekg(0);
+        aglio::StreamDeserializationView view{stream};
+        bool const                       ok = Serializer::deserialize(view, out);
+        escape(out);
+        return ok;
+    });
+
+    report(runner, "deserialize", "aglio", type, "buffered_stream", sizes, bytes, [&] {
+        stream.clear();
+        stream.seekg(0);
+        aglio::BufferedStreamDeserializationView view{stream, bytes};
+        bool const                               ok = Serializer::deserialize(view, out);
+        escape(out);
+        return ok;
+    });
+}
+
+template<typename Type>
+void bench_beve(Test::bench::Runner& runner) {
+    auto const type = Named<Type>::name;
+
+    Type const  value = Types::createDefault<Type>();
+    std::string encoded{};
+    if(glz::write_beve(value, encoded)) {
+        runner.failed = true;
+        return;
+    }
+    auto const bytes = encoded.size();
+
+    std::string buffer{};
+    report(runner, "serialize", "glaze_beve", type, "dynamic", "-", bytes, [&] {
+        buffer.clear();
+        bool const ok = !glz::write_beve(value, buffer);
+        escape(buffer);
+        return ok;
+    });
+
+    Type out{};
+    report(runner, "deserialize", "glaze_beve", type, "dynamic", "-", bytes, [&] {
+        bool const ok = !glz::read_beve(out, encoded);
+        escape(out);
+        return ok;
+    });
+}
+
+template<typename Type>
+void bench_type(Test::bench::Runner& runner) {
+    [&]<typename... Sizes>(std::tuple<Sizes...>*) {
+        (bench_aglio<Type, Sizes>(runner), ...);
+    }(static_cast<SizesList*>(nullptr));
+
+    // glaze has no BEVE encoding for std::chrono durations
+    if constexpr(!std::is_same_v<Type, Types::Chrono>) { bench_beve<Type>(runner); }
+}
+
+}   // namespace
+
+int main(int    argc,
+         char** argv) {
+    Test::bench::Runner runner{Test::bench::Arguments{argc, argv}};
+
+    [&]<typename... Ts>(std::tuple<Ts...>*) {
+        (bench_type<Ts>(runner), ...);
+    }(static_cast<Types::List*>(nullptr));
+
+    return runner.failed ? 1 : 0;
+}
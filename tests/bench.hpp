@@ -0,0 +1,112 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace Test::bench {
+
+// keeps the optimizer from dropping the measured work
+template<typename T>
+void escape(T const& v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&v) : "memory");
+#else
+    static void const* volatile sink{};
+    sink = &v;
+#endif
+}
+
+// key=value command line arguments
+struct Arguments {
+private:
+    std::map<std::string, std::string, std::less<>> values_{};
+
+public:
+    Arguments(int    argc,
+              char** argv) {
+        for(int i = 1; i < argc; ++i) {
+            std::string_view const arg{argv[i]};
+            auto const             pos = arg.find('=');
+            if(pos == std::string_view::npos) { continue; }
+            values_.emplace(arg.substr(0, pos), arg.substr(pos + 1));
+        }
+    }
+
+    template<typename T>
+    T get(std::string_view key,
+          T                fallback) const {
+        auto const it = values_.find(key);
+        if(it == values_.end()) { return fallback; }
+        if constexpr(std::is_same_v<T, std::string>) {
+            return it->second;
+        } else {
+            T          v{};
+            auto const result
+              = std::from_chars(it->second.data(), it->second.data() + it->second.size(), v);
+            return result.ec == std::errc{} ? v : fallback;
+        }
+    }
+};
+
+struct Measurement {
+    std::uint64_t iterations{};
+    double        ns_per_op{};
+};
+
+struct Runner {
+    std::string              filter{};
+    std::chrono::nanoseconds minTime{std::chrono::milliseconds{200}};
+    bool                     failed{};
+
+    explicit Runner(Arguments const& arguments)
+      : filter{arguments.get<std::string>("filter", {})}
+      , minTime{std::chrono::milliseconds{arguments.get<std::int64_t>("min_time_ms", 200)}} {}
+
+    // Runs f in batches of growing size until a batch takes at least minTime. Returns nothing
+    // when name does not match the filter or f failed.
+    template<typename F>
+    std::optional<Measurement> measure(std::string_view name,
+                                       F&&              f) {
+        if(name.find(filter) == std::string_view::npos) { return std::nullopt; }
+
+        using clock = std::chrono::steady_clock;
+        std::uint64_t            iterations{1};
+        std::chrono::nanoseconds elapsed{};
+        while(true) {
+            auto const start = clock::now();
+            for(std::uint64_t i = 0; i != iterations; ++i) {
+                if(!f()) {
+                    fmt::print(stderr, "{} failed\n", name);
+                    failed = true;
+                    return std::nullopt;
+                }
+            }
+            elapsed = clock::now() - start;
+            if(elapsed >= minTime) { break; }
+            iterations *= 2;
+        }
+
+        return Measurement{.iterations = iterations,
+                           .ns_per_op  = static_cast<double>(elapsed.count())
+                                      / static_cast<double>(iterations)};
+    }
+};
+
+// MB/s of bytes processed per operation
+inline double mb_per_s(std::size_t        bytes,
+                       Measurement const& m) {
+    return static_cast<double>(bytes) * 1e3 / m.ns_per_op;
+}
+
+}   // namespace Test::bench
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+namespace Test {
+
+template<typename T, typename TTuple>
+struct product_one_trait;
+
+template<typename T, typename... Us>
+struct product_one_trait<T, std::tuple<Us...>> {
+    using type = std::tuple<std::tuple<T, Us>...>;
+};
+
+template<typename TTuple1, typename TTuple2>
+struct cartesian_product;
+
+template<typename... Ts, typename... Us>
+struct cartesian_product<std::tuple<Ts...>, std::tuple<Us...>> {
+    using type = decltype(std::tuple_cat(
+      std::declval<typename product_one_trait<Ts, std::tuple<Us...>>::type>()...));
+};
+
+}   // namespace Test
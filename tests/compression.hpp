@@ -0,0 +1,115 @@
+#pragma once
+
+#include <aglio/compression.hpp>
+#include <random>
+#include <vector>
+
+namespace Test::compression {
+inline std::vector<std::byte> compress(std::span<std::byte const> input) {
+    std::vector<std::byte> compressed(aglio::LzRle::bound(input.size()));
+    compressed.resize(aglio::LzRle::compress(input, compressed));
+    return compressed;
+}
+
+inline void round_trip(std::span<std::byte const> input) {
+    auto const compressed = compress(input);
+    CHECK(compressed.size() <= aglio::LzRle::bound(input.size()));
+
+    std::vector<std::byte> output(input.size());
+    REQUIRE(aglio::LzRle::decompress(compressed, output));
+    CHECK(std::ranges::equal(output, input));
+
+    // the size has to match exactly
+    std::vector<std::byte> longer(input.size() + 1);
+    CHECK_FALSE(aglio::LzRle::decompress(compressed, longer));
+    if(!input.empty()) {
+        std::vector<std::byte> shorter(input.size() - 1);
+        CHECK_FALSE(aglio::LzRle::decompress(compressed, shorter));
+    }
+}
+
+inline std::vector<std::byte> random_bytes(std::size_t   size,
+                                           std::uint64_t seed) {
+    std::mt19937_64                         rng{seed};
+    std::uniform_int_distribution<unsigned> byte{0, 255};
+    std::vector<std::byte>                  bytes(size);
+    for(auto& b : bytes) { b = static_cast<std::byte>(byte(rng)); }
+    return bytes;
+}
+}   // namespace Test::compression
+
+TEST_CASE("LzRle round trip", "[compression]") {
+    using Test::compression::round_trip;
+
+    for(std::size_t const size : {0UZ, 1UZ, 3UZ, 4UZ, 15UZ, 16UZ, 270UZ, 5000UZ, 70000UZ}) {
+        round_trip(std::vector<std::byte>(size));
+        round_trip(Test::compression::random_bytes(size, size));
+
+        std::vector<std::byte> pattern(size);
+        for(std::size_t i = 0; i != size; ++i) {
+            pattern[i] = static_cast<std::byte>(i % 7 == 0 ? 0 : (i / 3) % 13);
+        }
+        round_trip(pattern);
+    }
+
+    // runs and matches between literals, matches further back than the offset can reach
+    auto mixed = Test::compression::random_bytes(1000, 1);
+    mixed.insert(mixed.end(), 300, std::byte{});
+    auto const random = Test::compression::random_bytes(70000, 2);
+    mixed.insert(mixed.end(), random.begin(), random.end());
+    std::vector<std::byte> const head{mixed.begin(), std::next(mixed.begin(), 2000)};
+    mixed.insert(mixed.end(), head.begin(), head.end());
+    round_trip(mixed);
+}
+
+TEST_CASE("LzRle ratio", "[compression]") {
+    std::vector<std::byte> zeros(10000);
+    CHECK(Test::compression::compress(zeros).size() < 50);
+
+    std::vector<std::byte> text{};
+    for(int i = 0; i != 200; ++i) {
+        for(char const c : std::string_view{"2026-10-16 info packager: frame sent\n"}) {
+            text.push_back(static_cast<std::byte>(c));
+        }
+    }
+    CHECK(Test::compression::compress(text).size() * 10 < text.size());
+
+    auto const random = Test::compression::random_bytes(10000, 3);
+    CHECK(Test::compression::compress(random).size() <= aglio::LzRle::bound(random.size()));
+}
+
+TEST_CASE("LzRle malformed input", "[compression]") {
+    std::vector<std::byte> output(16);
+
+    // nothing at all, a match before any output, an offset past the output
+    CHECK_FALSE(aglio::LzRle::decompress({}, output));
+    std::vector<std::byte> const early{std::byte{0x0C}, std::byte{0x01}, std::byte{0x00}};
+    CHECK_FALSE(aglio::LzRle::decompress(early, output));
+
+    // 4 literals, then a match of 16 bytes that does not fit
+    std::vector<std::byte> sequence{std::byte{0x4C},
+                                    std::byte{1},
+                                    std::byte{2},
+                                    std::byte{3},
+                                    std::byte{4},
+                                    std::byte{0x04},
+                                    std::byte{0x00},
+                                    std::byte{0x00}};
+    CHECK_FALSE(aglio::LzRle::decompress(sequence, output));
+
+    // a match of 12 bytes fills it exactly
+    sequence[0] = std::byte{0x48};
+    REQUIRE(aglio::LzRle::decompress(sequence, output));
+    CHECK(output[15] == std::byte{4});
+
+    // the last sequence cannot have a match
+    sequence.back() = std::byte{0x01};
+    CHECK_FALSE(aglio::LzRle::decompress(sequence, output));
+
+    // a truncated stream
+    std::vector<std::byte> data(64, std::byte{7});
+    auto                   compressed = Test::compression::compress(data);
+    compressed.pop_back();
+    std::vector<std::byte> out(data.size());
+    CHECK_FALSE(aglio::LzRle::decompress(compressed, out));
+}
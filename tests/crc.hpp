@@ -0,0 +1,48 @@
+#pragma once
+
+#include <aglio/crc.hpp>
+#include <numeric>
+#include <vector>
+
+namespace Test::crc {
+inline constexpr std::array<std::byte, 9> check_input = [] {
+    std::array<std::byte, 9> input{};
+    for(std::size_t i = 0; i != input.size(); ++i) { input[i] = static_cast<std::byte>('1' + i); }
+    return input;
+}();
+
+template<typename Crc, typename Tables>
+void test_against_tables() {
+    std::vector<std::byte> data(4096);
+    std::iota(reinterpret_cast<std::uint8_t*>(data.data()),
+              reinterpret_cast<std::uint8_t*>(data.data()) + data.size(),
+              std::uint8_t{});
+
+    for(std::size_t size :
+        {0UZ, 1UZ, 7UZ, 8UZ, 15UZ, 63UZ, 64UZ, 65UZ, 127UZ, 128UZ, 1000UZ, 4096UZ})
+    {
+        for(std::size_t offset : {0UZ, 1UZ, 3UZ}) {
+            auto const span = std::span<std::byte const>{data}.subspan(offset).first(
+              std::min(size, data.size() - offset));
+            CHECK(Crc::calc(span) == static_cast<typename Crc::type>(~Tables::update(~0U, span)));
+        }
+    }
+}
+}   // namespace Test::crc
+
+TEST_CASE("Crc check values", "[crc]") {
+    using Test::crc::check_input;
+
+    STATIC_REQUIRE(aglio::Crc16Ccitt::calc(check_input) == 0x29B1);
+    STATIC_REQUIRE(aglio::Crc32::calc(check_input) == 0xCBF4'3926);
+    STATIC_REQUIRE(aglio::Crc32c::calc(check_input) == 0xE306'9283);
+
+    CHECK(aglio::Crc16Ccitt::calc(check_input) == 0x29B1);
+    CHECK(aglio::Crc32::calc(check_input) == 0xCBF4'3926);
+    CHECK(aglio::Crc32c::calc(check_input) == 0xE306'9283);
+}
+
+TEST_CASE("Crc hardware paths", "[crc]") {
+    Test::crc::test_against_tables<aglio::Crc32, aglio::detail::crc32_tables>();
+    Test::crc::test_against_tables<aglio::Crc32c, aglio::detail::crc32c_tables>();
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <aglio/delta.hpp>
+#include <aglio/serialization_buffers.hpp>
+
+#include <string>
+#include <vector>
+
+namespace Test::delta {
+
+struct State {
+    std::uint64_t      timestamp{};
+    double             x{};
+    double             y{};
+    std::uint16_t      mode{};
+    std::string        label{};
+    std::vector<int>   errors{};
+    Types::Primitive   primitive{};
+    Types::Color       color{};
+    std::optional<int> target{};
+
+#ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wfloat-equal"
+#endif
+    constexpr auto operator<=>(State const&) const = default;
+#ifdef __clang__
+    #pragma clang diagnostic pop
+#endif
+};
+
+using SizesList
+  = std::tuple<std::uint16_t, aglio::VarintIntegers<std::uint16_t>, aglio::Compact<std::uint32_t>>;
+
+template<typename Size_t>
+std::vector<std::byte> encode(aglio::DeltaSerializer<State, Size_t>& serializer,
+                              State const&                           state) {
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView view{buffer};
+    REQUIRE(serializer.serialize(view, state));
+    return buffer;
+}
+
+template<typename Size_t>
+bool decode(aglio::DeltaDeserializer<State, Size_t>& deserializer,
+            std::vector<std::byte> const&            buffer) {
+    aglio::DynamicDeserializationView view{buffer};
+    return deserializer.deserialize(view) && view.available() == 0;
+}
+}   // namespace Test::delta
+
+TEMPLATE_LIST_TEST_CASE("Delta", "[delta]", Test::delta::SizesList) {
+    using Size_t = TestType;
+    using Test::delta::State;
+
+    aglio::DeltaSerializer<State, Size_t>   serializer{};
+    aglio::DeltaDeserializer<State, Size_t> deserializer{};
+
+    State state{.timestamp = 1,
+                .x         = 1.5,
+                .label     = "start",
+                .errors    = {1, 2},
+                .primitive = Types::createDefault<Types::Primitive>()};
+
+    auto const keyframe = Test::delta::encode(serializer, state);
+    CHECK_FALSE(deserializer.synced());
+    REQUIRE(Test::delta::decode(deserializer, keyframe));
+    CHECK(deserializer.synced());
+    CHECK(deserializer.value() == state);
+
+    // only the timestamp changes
+    state.timestamp = 2;
+    auto const small = Test::delta::encode(serializer, state);
+    CHECK(small.size() < keyframe.size() / 4);
+    REQUIRE(Test::delta::decode(deserializer, small));
+    CHECK(deserializer.value() == state);
+
+    state.timestamp = 3;
+    state.x         = -0.0;
+    state.label.clear();
+    state.target = 4;
+    REQUIRE(Test::delta::decode(deserializer, Test::delta::encode(serializer, state)));
+    CHECK(deserializer.value() == state);
+    CHECK(std::signbit(deserializer.value().x));
+
+    // nothing changed, only the header and the mask
+    auto const unchanged = Test::delta::encode(serializer, state);
+    REQUIRE(Test::delta::decode(deserializer, unchanged));
+    CHECK(deserializer.value() == state);
+
+    // a lost delta unsyncs until the next keyframe
+    state.mode = 7;
+    static_cast<void>(Test::delta::encode(serializer, state));
+    state.timestamp = 5;
+    CHECK_FALSE(Test::delta::decode(deserializer, Test::delta::encode(serializer, state)));
+    CHECK_FALSE(deserializer.synced());
+    state.timestamp = 6;
+    CHECK_FALSE(Test::delta::decode(deserializer, Test::delta::encode(serializer, state)));
+
+    serializer.force_keyframe();
+    state.timestamp = 7;
+    REQUIRE(Test::delta::decode(deserializer, Test::delta::encode(serializer, state)));
+    CHECK(deserializer.synced());
+    CHECK(deserializer.value() == state);
+    CHECK(deserializer.sequence() + 1 == serializer.next_sequence());
+}
+
+TEST_CASE("Delta keyframe interval", "[delta]") {
+    using Test::delta::State;
+
+    aglio::DeltaSerializer<State>   serializer{3};
+    aglio::DeltaDeserializer<State> late{};
+
+    State             state{};
+    std::vector<bool> keyframes{};
+    for(std::uint64_t i = 0; i != 8; ++i) {
+        state.timestamp  = i;
+        auto const bytes = Test::delta::encode(serializer, state);
+        keyframes.push_back(bytes.front() == std::byte{0});
+        // joins after the first keyframe was sent
+        if(i >= 1) { CHECK(Test::delta::decode(late, bytes) == (i >= 3)); }
+    }
+    CHECK(keyframes == std::vector{true, false, false, true, false, false, true, false});
+    CHECK(late.value() == state);
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "packager_configs.hpp"
+#include "types.hpp"
+
+#include <aglio/crc.hpp>
+#include <aglio/log.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace Test::log {
+
+struct Config {
+    using Crc                                   = aglio::Crc32c;
+    using Size_t                                = std::uint32_t;
+    static constexpr std::uint16_t PackageStart = 0xABCD;
+};
+
+using Writer = aglio::LogWriter<Config>;
+using Reader = aglio::LogReader<Config>;
+
+struct TempDirectory {
+    std::filesystem::path path;
+
+    TempDirectory()
+      : path{std::filesystem::temp_directory_path()
+             / ("aglio_log_test_" + std::to_string(std::random_device{}()))} {
+        std::filesystem::remove_all(path);
+    }
+
+    TempDirectory(TempDirectory const&)            = delete;
+    TempDirectory& operator=(TempDirectory const&) = delete;
+
+    ~TempDirectory() {
+        std::error_code ec{};
+        std::filesystem::remove_all(path, ec);
+    }
+};
+
+inline Types::Container value(std::uint64_t sequence) {
+    auto v = Types::createDefault<Types::Container>();
+    v.vec.push_back(static_cast<int>(sequence));
+    return v;
+}
+
+inline void write(Writer&       writer,
+                  std::uint64_t count) {
+    for(std::uint64_t i = 0; i != count; ++i) {
+        auto const sequence = writer.next_sequence();
+        REQUIRE(writer.append(static_cast<std::int64_t>(sequence * 10), value(sequence))
+                == sequence);
+    }
+    REQUIRE(writer.flush());
+}
+
+inline void check(Reader::Record const& record,
+                  std::uint64_t         sequence) {
+    CHECK(record.sequence == sequence);
+    CHECK(record.timestamp == static_cast<std::int64_t>(sequence * 10));
+    Types::Container v{};
+    REQUIRE(Reader::decode(record, v));
+    CHECK(v == value(sequence));
+}
+}   // namespace Test::log
+
+TEST_CASE("Log read, seek and tail", "[log]") {
+    using namespace Test::log;
+
+    TempDirectory const directory{};
+
+    Writer writer{directory.path, {.segmentSize = 4096, .indexInterval = 256}};
+    REQUIRE(writer.is_open());
+    write(writer, 1000);
+    CHECK(std::ranges::distance(std::filesystem::directory_iterator{directory.path}) > 4);
+
+    Reader reader{directory.path};
+    for(std::uint64_t sequence = 0; sequence != 1000; ++sequence) {
+        auto const record = reader.next();
+        REQUIRE(record.has_value());
+        check(*record, sequence);
+    }
+    CHECK_FALSE(reader.next().has_value());
+
+    REQUIRE(reader.seek(537));
+    check(reader.next().value(), 537);
+    CHECK_FALSE(reader.seek(1000));
+
+    REQUIRE(reader.seek_time(5005));
+    check(reader.next().value(), 501);
+    REQUIRE(reader.seek_time(0));
+    check(reader.next().value(), 0);
+    CHECK_FALSE(reader.seek_time(10000));
+
+    // tailing picks up records of the current segment and new segments
+    REQUIRE(reader.seek(999));
+    check(reader.next().value(), 999);
+    CHECK_FALSE(reader.next().has_value());
+    write(writer, 100);
+    reader.refresh();
+    for(std::uint64_t sequence = 1000; sequence != 1100; ++sequence) {
+        auto const record = reader.next();
+        REQUIRE(record.has_value());
+        check(*record, sequence);
+    }
+}
+
+TEST_CASE("Log recovery", "[log]") {
+    using namespace Test::log;
+
+    TempDirectory const directory{};
+    {
+        Writer writer{directory.path, {.segmentSize = 4096, .indexInterval = 256}};
+        write(writer, 100);
+    }
+
+    // a torn frame at the end of the last segment
+    auto const segments = aglio::detail::log_segments(directory.path);
+    REQUIRE_FALSE(segments.empty());
+    {
+        std::ofstream file{aglio::detail::log_segment_path(directory.path, segments.back(), ".log"),
+                           std::ios::binary | std::ios::app};
+        file.write("\xCD\xAB\x40\x00", 4);
+    }
+
+    Writer writer{directory.path, {.segmentSize = 4096, .indexInterval = 256}};
+    REQUIRE(writer.is_open());
+    CHECK(writer.next_sequence() == 100);
+    write(writer, 10);
+
+    Reader        reader{directory.path};
+    std::uint64_t sequence{};
+    while(auto const record = reader.next()) { check(*record, sequence++); }
+    CHECK(sequence == 110);
+}
+
+TEST_CASE("Log recovery keeps records after damage", "[log]") {
+    using namespace Test::log;
+
+    TempDirectory const directory{};
+    {
+        Writer writer{directory.path};
+        write(writer, 30);
+    }
+
+    // a flipped byte in the middle of the only segment, past its only index entry
+    auto const log  = aglio::detail::log_segment_path(directory.path, 0, ".log");
+    auto const size = std::filesystem::file_size(log);
+    {
+        std::fstream file{log, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(static_cast<std::streamoff>(size / 2));
+        file.put('\x5A');
+    }
+
+    // the damaged segment stays as it is and the writer goes on in a new one
+    Writer writer{directory.path};
+    REQUIRE(writer.is_open());
+    CHECK_FALSE(writer.error());
+    CHECK(writer.next_sequence() == 30);
+    CHECK(std::filesystem::file_size(log) == size);
+    write(writer, 10);
+    CHECK(std::filesystem::exists(aglio::detail::log_segment_path(directory.path, 30, ".log")));
+
+    // the reader skips the damaged record and reports the gap
+    Reader                     reader{directory.path};
+    std::vector<std::uint64_t> sequences{};
+    std::vector<std::uint64_t> gaps{};
+    while(auto const record = reader.next()) {
+        check(*record, record->sequence);
+        sequences.push_back(record->sequence);
+        if(record->gap) { gaps.push_back(record->sequence); }
+    }
+    REQUIRE(sequences.size() == 39);
+    REQUIRE(gaps.size() == 1);
+    CHECK(gaps.front() > 0);
+    CHECK(std::ranges::is_sorted(sequences));
+    CHECK(std::ranges::find(sequences, gaps.front() - 1) == sequences.end());
+    CHECK(sequences.back() == 39);
+}
+
+TEST_CASE("Log reader numbers records after damage by the index", "[log]") {
+    using namespace Test::log;
+
+    TempDirectory const directory{};
+    {
+        Writer writer{directory.path, {.indexInterval = 256}};
+        write(writer, 30);
+    }
+
+    // zeros over several records, the index entry after them pins the sequence numbers down
+    auto const log  = aglio::detail::log_segment_path(directory.path, 0, ".log");
+    auto const size = std::filesystem::file_size(log);
+    {
+        std::fstream file{log, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(static_cast<std::streamoff>(size / 3));
+        std::string const zeros(size / 10, '\0');
+        file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    }
+
+    Reader        reader{directory.path};
+    std::size_t   records{};
+    std::size_t   gaps{};
+    std::uint64_t last{};
+    while(auto const record = reader.next()) {
+        check(*record, record->sequence);
+        if(record->gap) {
+            ++gaps;
+            CHECK(record->sequence > last + 2);
+        }
+        last = record->sequence;
+        ++records;
+    }
+    CHECK(gaps == 1);
+    CHECK(records < 28);
+    CHECK(last == 29);
+}
+
+TEST_CASE("Log compressed records", "[log][compression]") {
+    using Config = Test::packager::Configs::Compressed;
+    using Test::log::TempDirectory;
+
+    auto const text = [](std::uint64_t sequence) {
+        return std::string(200, static_cast<char>('a' + sequence % 26));
+    };
+
+    TempDirectory const directory{};
+    {
+        aglio::LogWriter<Config> writer{directory.path};
+        REQUIRE(writer.is_open());
+        for(std::uint64_t sequence = 0; sequence != 50; ++sequence) {
+            REQUIRE(writer.append(static_cast<std::int64_t>(sequence), text(sequence))
+                    == sequence);
+        }
+        REQUIRE(writer.flush());
+    }
+    CHECK(std::filesystem::file_size(
+            aglio::detail::log_segment_path(directory.path, 0, ".log"))
+          < 50 * 200);
+
+    // reopening has to see through the compressed frames as well
+    CHECK(aglio::LogWriter<Config>{directory.path}.next_sequence() == 50);
+
+    aglio::LogReader<Config> reader{directory.path};
+    for(std::uint64_t sequence = 0; sequence != 50; ++sequence) {
+        auto const record = reader.next();
+        REQUIRE(record.has_value());
+        CHECK(record->timestamp == static_cast<std::int64_t>(sequence));
+        std::string v{};
+        REQUIRE(aglio::LogReader<Config>::decode(*record, v));
+        CHECK(v == text(sequence));
+    }
+    CHECK_FALSE(reader.next().has_value());
+}
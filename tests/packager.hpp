@@ -1,105 +1,156 @@
 #pragma once
 
+#include "cartesian_product.hpp"
+#include "packager_configs.hpp"
 #include "types.hpp"
 
+#include <aglio/crc.hpp>
+#include <aglio/frame_decoder.hpp>
 #include <aglio/packager.hpp>
 
+#include <random>
+
 namespace Test::packager {
 
-struct MyCrc {
-    using type = std::uint32_t;
+using TestCases = typename cartesian_product<Types::List, ConfigsList>::type;
+
+template<typename Type,
+         typename Packager>
+void test() {
+    std::vector<std::byte> buffer{};
+
+    Type t_in = Types::createDefault<Type>();
+
+    Packager::pack(buffer, t_in);
+    Type t_out{};
+    auto result = Packager::unpack(buffer, t_out);
 
-    static type calc(std::span<std::byte const> data) {
-        // A dummy CRC function for testing
-        type crc = 0;
-        for(auto b : data) { crc += static_cast<type>(b); }
-        return crc;
+    REQUIRE(result.has_value());
+    CHECK(buffer.size() == *result);
+    CHECK(t_in == t_out);
+}
+
+template<typename Type,
+         typename Config>
+void test_frame_decoder() {
+    using Packager = aglio::Packager<Config>;
+
+    std::vector<std::byte> stream{};
+
+    Type const t_in = Types::createDefault<Type>();
+
+    // garbage between frames can only be skipped when there is a PackageStart to resync on
+    constexpr bool Resyncs = requires { Config::PackageStart; };
+
+    for(std::size_t i = 0; i != 5; ++i) {
+        Packager::pack(stream, t_in);
+        if constexpr(Resyncs) { stream.insert(stream.end(), i, std::byte{0xAB}); }
     }
-};
 
-namespace Configs {
+    for(std::size_t const chunk : {std::size_t{1}, std::size_t{7}, std::size_t{64}, stream.size()}) {
+        aglio::FrameDecoder<Config> decoder{};
+        std::size_t                 decoded{};
 
-    // Minimal (Size_t only, no CRC, no PackageStart)
-    struct Minimal {
-        using Size_t = std::uint32_t;
-    };
+        for(std::size_t pos = 0; pos < stream.size(); pos += chunk) {
+            auto const data = std::span<std::byte const>{stream}.subspan(
+              pos,
+              std::min(chunk, stream.size() - pos));
+            decoded += decoder.template feed<Type>(data, [&](Type&& t_out) {
+                CHECK(t_in == t_out);
+            });
+        }
 
-    // PackageStart only (no CRC)
-    struct SimplePackageStart {
-        using Size_t                                = std::uint32_t;
-        static constexpr std::uint16_t PackageStart = 0xABCD;
-    };
+        CHECK(decoded == 5);
+    }
+}
 
-    // CRC only (UseHeaderCrc defaults to true when CRC present)
-    struct SimpleCrc {
-        using Crc    = MyCrc;
-        using Size_t = std::uint32_t;
-    };
+template<typename Type,
+         typename Config>
+void test_unpack_all() {
+    using Packager = aglio::Packager<Config>;
 
-    // CRC with UseHeaderCrc explicitly disabled
-    struct CrcNoHeader {
-        using Crc                          = MyCrc;
-        using Size_t                       = std::uint32_t;
-        static constexpr bool UseHeaderCrc = false;
-    };
+    constexpr bool Resyncs = requires { Config::PackageStart; };
 
-    // PackageStart + CRC (implicit UseHeaderCrc=true)
-    struct Full {
-        using Crc                                   = MyCrc;
-        using Size_t                                = std::uint32_t;
-        static constexpr std::uint16_t PackageStart = 0xABCD;
-    };
+    std::vector<std::byte> buffer{};
 
-    // PackageStart + CRC with UseHeaderCrc=false
-    struct FullNoHeaderCrc {
-        using Crc                                   = MyCrc;
-        using Size_t                                = std::uint32_t;
-        static constexpr std::uint16_t PackageStart = 0xABCD;
-        static constexpr bool          UseHeaderCrc = false;
-    };
+    Type const t_in = Types::createDefault<Type>();
+
+    for(std::size_t i = 0; i != 10; ++i) {
+        Packager::pack(buffer, t_in);
+        if constexpr(Resyncs) {
+            if(i == 3) {
+                // corrupt the start of the frame
+                buffer.push_back(static_cast<std::byte>(Config::PackageStart & 0xFF));
+            }
+        }
+    }
+    auto const complete = buffer.size();
+    Packager::pack(buffer, t_in);
+    buffer.resize(buffer.size() - 1);
 
-}   // namespace Configs
+    std::vector<Type> out{};
+    auto const        result = Packager::template unpack_all<Type>(buffer, std::back_inserter(out));
 
-template<typename T, typename TTuple>
-struct product_one_trait;
+    CHECK(result.consumed == complete);
+    CHECK(result.decoded == 10);
+    CHECK(result.discarded == (Resyncs ? 1 : 0));
+    REQUIRE(out.size() == 10);
+    for(auto const& t_out : out) { CHECK(t_in == t_out); }
 
-template<typename T, typename... Us>
-struct product_one_trait<T, std::tuple<Us...>> {
-    using type = std::tuple<std::tuple<T, Us>...>;
-};
+    std::size_t decoded{};
+    Packager::template unpack_all<Type>(buffer, [&](Type&& t_out) {
+        CHECK(t_in == t_out);
+        ++decoded;
+    });
+    CHECK(decoded == 10);
+}
 
-template<typename TTuple1, typename TTuple2>
-struct cartesian_product;
+template<typename Type,
+         typename Config>
+void test_incremental_crc() {
+    std::vector<std::byte> incremental{};
+    std::vector<std::byte> calc{};
 
-template<typename... Ts, typename... Us>
-struct cartesian_product<std::tuple<Ts...>, std::tuple<Us...>> {
-    using type = decltype(std::tuple_cat(
-      std::declval<typename product_one_trait<Ts, std::tuple<Us...>>::type>()...));
-};
+    Type const t_in = Types::createDefault<Type>();
 
-using ConfigsList = std::tuple<Configs::Minimal,
-                               Configs::SimplePackageStart,
-                               Configs::SimpleCrc,
-                               Configs::CrcNoHeader,
-                               Configs::Full,
-                               Configs::FullNoHeaderCrc>;
+    aglio::Packager<Config>::pack(incremental, t_in);
+    aglio::Packager<Configs::CalcOnlyCrc<Config>>::pack(calc, t_in);
 
-using TestCases = typename cartesian_product<Types::List, ConfigsList>::type;
+    CHECK(incremental == calc);
+}
+
+template<typename Config>
+constexpr bool supports_gather() {
+    if constexpr(requires { typename Config::Crc; }) {
+        return aglio::detail::incremental_crc<typename Config::Crc>;
+    } else {
+        return true;
+    }
+}
 
 template<typename Type,
-         typename Packager>
-void test() {
-    std::vector<std::byte> buffer{};
+         typename Config>
+void test_gather() {
+    using Packager = aglio::Packager<Config>;
 
-    Type t_in = Types::createDefault<Type>();
+    Type const t_in = Types::createDefault<Type>();
 
-    Packager::pack(buffer, t_in);
-    Type t_out{};
-    auto result = Packager::unpack(buffer, t_out);
+    std::vector<std::byte> contiguous{};
+    Packager::pack(contiguous, t_in);
+    Packager::pack(contiguous, t_in);
 
-    REQUIRE(result.has_value());
-    CHECK(buffer.size() == *result);
-    CHECK(t_in == t_out);
+    // reference every contiguous trivial range, however small
+    aglio::GatherBuffer gather{0};
+    Packager::pack_gather(gather, t_in);
+    Packager::pack_gather(gather, t_in);
+
+    std::vector<std::byte> flattened{};
+    gather.for_each_segment([&](std::span<std::byte const> segment) {
+        flattened.insert(flattened.end(), segment.begin(), segment.end());
+    });
+
+    CHECK(gather.size() == contiguous.size());
+    CHECK(flattened == contiguous);
 }
 }   // namespace Test::packager
 
@@ -111,3 +162,206 @@ TEMPLATE_LIST_TEST_CASE("Packager",
 
     Test::packager::test<Type, aglio::Packager<Config>>();
 }
+
+TEMPLATE_LIST_TEST_CASE("FrameDecoder",
+                        "[cartesian]",
+                        Test::packager::TestCases) {
+    using Type   = std::tuple_element_t<0, TestType>;
+    using Config = std::tuple_element_t<1, TestType>;
+
+    Test::packager::test_frame_decoder<Type, Config>();
+}
+
+TEMPLATE_LIST_TEST_CASE("Packager unpack_all",
+                        "[cartesian]",
+                        Test::packager::TestCases) {
+    using Type   = std::tuple_element_t<0, TestType>;
+    using Config = std::tuple_element_t<1, TestType>;
+
+    Test::packager::test_unpack_all<Type, Config>();
+}
+
+TEMPLATE_LIST_TEST_CASE("Packager gather",
+                        "[cartesian]",
+                        Test::packager::TestCases) {
+    using Type   = std::tuple_element_t<0, TestType>;
+    using Config = std::tuple_element_t<1, TestType>;
+
+    if constexpr(Test::packager::supports_gather<Config>()) {
+        Test::packager::test_gather<Type, Config>();
+    }
+}
+
+TEST_CASE("Packager gather references large ranges", "[gather]") {
+    using Packager = aglio::Packager<Test::packager::Configs::BuiltinCrcNoHeader>;
+
+    std::vector<std::uint16_t> const samples(4096, 0x1234);
+
+    aglio::GatherBuffer gather{};
+    Packager::pack_gather(gather, samples);
+
+    auto const segments = gather.segments();
+    REQUIRE(segments.size() == 3);
+    CHECK(segments[1].data() == reinterpret_cast<std::byte const*>(samples.data()));
+    CHECK(segments[1].size() == samples.size() * sizeof(std::uint16_t));
+
+#if __has_include(<sys/uio.h>)
+    auto const iov = gather.iovecs();
+    REQUIRE(iov.size() == 3);
+    CHECK(iov[1].iov_base == samples.data());
+#endif
+
+    std::vector<std::byte> flattened{};
+    for(auto const segment : segments) {
+        flattened.insert(flattened.end(), segment.begin(), segment.end());
+    }
+    std::vector<std::uint16_t> out{};
+    REQUIRE(Packager::unpack(flattened, out) == flattened.size());
+    CHECK(out == samples);
+}
+
+TEMPLATE_LIST_TEST_CASE("Packager incremental crc",
+                        "[crc]",
+                        Types::List) {
+    Test::packager::test_incremental_crc<TestType, Test::packager::Configs::BuiltinCrc>();
+    Test::packager::test_incremental_crc<TestType, Test::packager::Configs::BuiltinCrcNoHeader>();
+}
+
+TEST_CASE("Packager byte order", "[byte_order]") {
+    using Packager = aglio::Packager<Test::packager::Configs::BigEndianFrames>;
+
+    std::vector<std::byte> buffer{};
+    Packager::pack(buffer, std::uint32_t{0x0102'0304});
+
+    REQUIRE(buffer.size() == 2 + 2 + 4 + 4 + 4);
+    CHECK(buffer[0] == std::byte{0xAB});
+    CHECK(buffer[1] == std::byte{0xCD});
+    CHECK(buffer[2] == std::byte{0x00});
+    CHECK(buffer[3] == std::byte{0x08});
+    CHECK(buffer[8] == std::byte{0x01});
+    CHECK(buffer[11] == std::byte{0x04});
+
+    auto const bodyCrc = aglio::Crc32::calc(std::span{buffer}.subspan(8, 4));
+    CHECK(buffer[12] == static_cast<std::byte>(bodyCrc >> 24));
+    CHECK(buffer[15] == static_cast<std::byte>(bodyCrc & 0xFF));
+}
+
+TEST_CASE("Packager resync", "[resync]") {
+    using Packager = aglio::Packager<Test::packager::Configs::Full>;
+
+    std::vector<std::byte> buffer(300, std::byte{0xCD});
+    buffer.push_back(std::byte{0xAB});
+    Packager::pack(buffer, Types::createDefault<Types::Primitive>());
+    auto const complete = buffer.size();
+    buffer.push_back(std::byte{0xCD});
+
+    std::vector<Types::Primitive> out{};
+    auto const                    result
+      = Packager::unpack_all<Types::Primitive>(buffer, std::back_inserter(out));
+
+    CHECK(result.decoded == 1);
+    CHECK(result.discarded == 1);
+    CHECK(result.consumed == complete);
+    REQUIRE(out.size() == 1);
+    CHECK(out[0] == Types::createDefault<Types::Primitive>());
+}
+
+TEST_CASE("Packager resync without package start", "[resync]") {
+    using Packager = aglio::Packager<Test::packager::Configs::SimpleCrc>;
+
+    auto const value = Types::createDefault<Types::Primitive>();
+
+    // without a start pattern resync steps over garbage byte by byte
+    std::vector<std::byte> buffer{};
+    Packager::pack(buffer, value);
+    buffer.insert(buffer.end(), 100, std::byte{0xFF});
+    Packager::pack(buffer, value);
+    Packager::pack(buffer, value);
+    buffer.insert(buffer.end(), 50, std::byte{0xEE});
+    Packager::pack(buffer, value);
+
+    std::vector<Types::Primitive> out{};
+    auto const                    result
+      = Packager::unpack_all<Types::Primitive>(buffer, std::back_inserter(out));
+
+    CHECK(result.decoded == 4);
+    CHECK(result.discarded == 2);
+    CHECK(result.consumed == buffer.size());
+    CHECK(out == std::vector<Types::Primitive>(4, value));
+}
+
+TEMPLATE_LIST_TEST_CASE("Packager compression",
+                        "[compression]",
+                        Types::List) {
+    using Config = Test::packager::Configs::Compressed;
+
+    Test::packager::test<TestType, aglio::Packager<Config>>();
+    Test::packager::test_frame_decoder<TestType, Config>();
+    Test::packager::test_unpack_all<TestType, Config>();
+}
+
+TEST_CASE("Packager compressed frames", "[compression]") {
+    using Config   = Test::packager::Configs::Compressed;
+    using Packager = aglio::Packager<Config>;
+
+    // PackageStart, size and header crc
+    constexpr std::size_t HeaderSize = 2 + 4 + 4;
+
+    auto const compressed = [](std::span<std::byte const> frame) {
+        auto const size = aglio::detail::from_bytes<std::endian::native, std::uint32_t>(
+          frame.subspan(2));
+        return (size >> 31) != 0;
+    };
+
+    std::vector<std::uint32_t> samples(1000);
+    for(std::size_t i = 0; i != samples.size(); ++i) {
+        samples[i] = static_cast<std::uint32_t>(i / 50);
+    }
+
+    std::vector<std::byte> buffer{};
+    Packager::pack(buffer, samples);
+    CHECK(compressed(buffer));
+    CHECK(buffer.size() < samples.size());
+
+    std::vector<std::uint32_t> out{};
+    REQUIRE(Packager::unpack(buffer, out) == buffer.size());
+    CHECK(out == samples);
+
+    // small bodies and bodies that do not get smaller are sent as they are
+    std::vector<std::byte> small{};
+    Packager::pack(small, std::uint64_t{42});
+    CHECK_FALSE(compressed(small));
+    CHECK(small.size() == HeaderSize + 8 + 4);
+
+    std::vector<std::uint8_t> noise(1000);
+    std::mt19937              rng{7};
+    for(auto& n : noise) { n = static_cast<std::uint8_t>(rng()); }
+    std::vector<std::byte> raw{};
+    Packager::pack(raw, noise);
+    CHECK_FALSE(compressed(raw));
+    CHECK(raw.size() == HeaderSize + 4 + noise.size() + 4);
+
+    // scatter-gather frames are never compressed
+    aglio::GatherBuffer gather{};
+    Packager::pack_gather(gather, samples);
+    std::vector<std::byte> flattened{};
+    gather.for_each_segment([&](std::span<std::byte const> segment) {
+        flattened.insert(flattened.end(), segment.begin(), segment.end());
+    });
+    CHECK_FALSE(compressed(flattened));
+    REQUIRE(Packager::unpack(flattened, out) == flattened.size());
+    CHECK(out == samples);
+
+    // MaxSize limits the uncompressed size too
+    using SmallFrames = aglio::Packager<Test::packager::Configs::CompressedSmallFrames>;
+    CHECK_FALSE(SmallFrames::unpack(buffer, out).has_value());
+
+    // and so does MaxUncompressedSize, which also keeps larger bodies from being compressed
+    using SmallBodies = aglio::Packager<Test::packager::Configs::CompressedSmallBodies>;
+    CHECK_FALSE(SmallBodies::unpack(buffer, out).has_value());
+    std::vector<std::byte> large{};
+    SmallBodies::pack(large, samples);
+    CHECK_FALSE(compressed(large));
+    REQUIRE(SmallBodies::unpack(large, out) == large.size());
+    CHECK(out == samples);
+}
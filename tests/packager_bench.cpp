@@ -0,0 +1,346 @@
+#include "bench.hpp"
+#include "packager_configs.hpp"
+#include "types.hpp"
+
+#include <aglio/packager.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Throughput of Packager::pack and unpack_all for every config of the packager tests, on a clean
+// frame stream and on one with injected bit flips, truncated frames and garbage runs. One JSON
+// object per line on stdout:
+//
+//   aglio_packager_bench [filter=<substring>] [min_time_ms=<ms>] [frames=<n>] [seed=<n>]
+//                        [ber=<bit error rate>] [truncation=<rate>] [garbage=<rate>]
+//
+// truncation and garbage are per frame probabilities, filter matches "<op>/<config>/<stream>".
+
+namespace {
+
+using namespace Test::packager;
+using Test::bench::escape;
+
+template<typename Config>
+struct ConfigName;
+
+template<>
+struct ConfigName<Configs::Minimal> {
+    static constexpr std::string_view name{"Minimal"};
+};
+
+template<>
+struct ConfigName<Configs::SimplePackageStart> {
+    static constexpr std::string_view name{"SimplePackageStart"};
+};
+
+template<>
+struct ConfigName<Configs::SimpleCrc> {
+    static constexpr std::string_view name{"SimpleCrc"};
+};
+
+template<>
+struct ConfigName<Configs::CrcNoHeader> {
+    static constexpr std::string_view name{"CrcNoHeader"};
+};
+
+template<>
+struct ConfigName<Configs::Full> {
+    static constexpr std::string_view name{"Full"};
+};
+
+template<>
+struct ConfigName<Configs::FullNoHeaderCrc> {
+    static constexpr std::string_view name{"FullNoHeaderCrc"};
+};
+
+template<>
+struct ConfigName<Configs::BuiltinCrc> {
+    static constexpr std::string_view name{"BuiltinCrc"};
+};
+
+template<>
+struct ConfigName<Configs::BuiltinCrcNoHeader> {
+    static constexpr std::string_view name{"BuiltinCrcNoHeader"};
+};
+
+template<>
+struct ConfigName<Configs::BigEndianFrames> {
+    static constexpr std::string_view name{"BigEndianFrames"};
+};
+
+template<>
+struct ConfigName<Configs::Compressed> {
+    static constexpr std::string_view name{"Compressed"};
+};
+
+template<typename List>
+struct variant_of;
+
+template<typename... Ts>
+struct variant_of<std::tuple<Ts...>> {
+    using type = std::variant<Ts...>;
+};
+
+// sequence number and one of the test types, cycling through all of them
+using Payload = typename variant_of<Types::List>::type;
+using Message = std::pair<std::uint32_t, Payload>;
+
+std::vector<Message> make_messages(std::size_t count) {
+    std::vector<Message> messages(count);
+    for(std::size_t i = 0; i != count; ++i) {
+        messages[i].first = static_cast<std::uint32_t>(i);
+        [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            ((i % sizeof...(Is) == Is
+                ? (messages[i].second.emplace<Is>(
+                     Types::createDefault<std::variant_alternative_t<Is, Payload>>()),
+                   0)
+                : 0),
+             ...);
+        }(std::make_index_sequence<std::variant_size_v<Payload>>{});
+    }
+    return messages;
+}
+
+struct Noise {
+    double        bitErrorRate{};
+    double        truncationRate{};
+    double        garbageRate{};
+    std::size_t   maxGarbage{64};
+    std::uint64_t seed{};
+};
+
+struct NoisyStream {
+    std::vector<std::byte>   bytes{};
+    std::vector<std::size_t> intactStarts{};   // frames that are still complete and unchanged
+    std::vector<std::size_t> corruptions{};    // offsets where damage starts
+};
+
+NoisyStream make_noisy(std::vector<std::vector<std::byte>> const& frames,
+                       Noise const&                               noise) {
+    NoisyStream                                stream{};
+    std::mt19937_64                            rng{noise.seed};
+    std::bernoulli_distribution                truncate{noise.truncationRate};
+    std::bernoulli_distribution                garbage{noise.garbageRate};
+    std::uniform_int_distribution<std::size_t> garbageLength{1, noise.maxGarbage};
+    std::uniform_int_distribution<unsigned>    garbageByte{0, 255};
+
+    std::vector<std::pair<std::size_t, std::size_t>> complete{};
+    for(auto const& frame : frames) {
+        if(garbage(rng)) {
+            stream.corruptions.push_back(stream.bytes.size());
+            for(auto n = garbageLength(rng); n != 0; --n) {
+                stream.bytes.push_back(static_cast<std::byte>(garbageByte(rng)));
+            }
+        }
+        auto const start = stream.bytes.size();
+        if(frame.size() > 1 && truncate(rng)) {
+            stream.corruptions.push_back(start);
+            auto const cut = std::uniform_int_distribution<std::size_t>{1, frame.size() - 1}(rng);
+            stream.bytes.insert(stream.bytes.end(),
+                                frame.begin(),
+                                frame.begin() + static_cast<std::ptrdiff_t>(cut));
+        } else {
+            complete.emplace_back(start, frame.size());
+            stream.bytes.insert(stream.bytes.end(), frame.begin(), frame.end());
+        }
+    }
+
+    std::vector<std::size_t> flipped{};
+    if(noise.bitErrorRate > 0) {
+        std::geometric_distribution<std::uint64_t> gap{noise.bitErrorRate};
+        auto const                                 bits = stream.bytes.size() * 8;
+        for(auto bit = gap(rng); bit < bits; bit += 1 + gap(rng)) {
+            stream.bytes[bit / 8] ^= static_cast<std::byte>(1U << (bit % 8));
+            flipped.push_back(bit / 8);
+        }
+    }
+
+    for(auto const& [start, size] : complete) {
+        auto const hit = std::ranges::lower_bound(flipped, start);
+        if(hit == flipped.end() || *hit >= start + size) { stream.intactStarts.push_back(start); }
+    }
+    stream.corruptions.insert(stream.corruptions.end(), flipped.begin(), flipped.end());
+    std::ranges::sort(stream.corruptions);
+    return stream;
+}
+
+struct Recovery {
+    std::size_t decoded{};
+    std::size_t framesLost{};
+    std::size_t falseFrames{};
+    double      resyncBytesMean{};
+    std::size_t resyncBytesMax{};
+};
+
+// Walks the stream like unpack_all but keeps the offset of every accepted frame. Resync bytes
+// are the bytes between the first intact frame after a corruption and the first frame that is
+// decoded again, zero when the decoder picks up right at the next intact frame.
+template<typename Packager>
+Recovery analyze(NoisyStream const&          stream,
+                 std::vector<Message> const& messages) {
+    using Frames       = aglio::detail::FrameAccess<Packager>;
+    using HeaderStatus = typename Frames::HeaderStatus;
+
+    auto const               bytes = std::span<std::byte const>{stream.bytes};
+    std::vector<std::size_t> accepted{};
+    Recovery                 recovery{};
+    std::size_t              position{};
+    while(true) {
+        auto const span   = bytes.subspan(position);
+        auto const header = Frames::check_header(span);
+        if(header.status == HeaderStatus::Incomplete) { break; }
+        if(header.status == HeaderStatus::Invalid) {
+            position += Frames::resync_offset(span);
+            continue;
+        }
+        if(header.frameSize > span.size()) { break; }
+
+        auto const frame = span.first(header.frameSize);
+        Message    message{};
+        if(!Frames::check_body(frame) || !Frames::deserialize_body(frame, message)) {
+            position += Frames::resync_offset(span);
+            continue;
+        }
+
+        ++recovery.decoded;
+        if(message.first < messages.size() && message == messages[message.first]) {
+            accepted.push_back(position);
+        } else {
+            ++recovery.falseFrames;
+        }
+        position += header.frameSize;
+    }
+
+    for(auto const start : stream.intactStarts) {
+        if(!std::ranges::binary_search(accepted, start)) { ++recovery.framesLost; }
+    }
+
+    std::size_t events{};
+    std::size_t total{};
+    for(auto const corruption : stream.corruptions) {
+        auto const intact  = std::ranges::lower_bound(stream.intactStarts, corruption);
+        auto const decoded = std::ranges::lower_bound(accepted, corruption);
+        if(intact == stream.intactStarts.end() || decoded == accepted.end()) { continue; }
+        auto const bytes_lost = *decoded > *intact ? *decoded - *intact : 0;
+        total += bytes_lost;
+        recovery.resyncBytesMax = std::max(recovery.resyncBytesMax, bytes_lost);
+        ++events;
+    }
+    if(events != 0) {
+        recovery.resyncBytesMean = static_cast<double>(total) / static_cast<double>(events);
+    }
+    return recovery;
+}
+
+template<typename Config>
+void bench_config(Test::bench::Runner&        runner,
+                  std::vector<Message> const& messages,
+                  Noise const&                noise) {
+    using Packager   = aglio::Packager<Config>;
+    auto const name  = ConfigName<Config>::name;
+    auto const count = messages.size();
+
+    std::vector<std::vector<std::byte>> frames{};
+    std::vector<std::byte>              clean{};
+    for(auto const& message : messages) {
+        Packager::pack(frames.emplace_back(), message);
+        clean.insert(clean.end(), frames.back().begin(), frames.back().end());
+    }
+
+    auto const print = [&](std::string_view                op,
+                           std::string_view                stream,
+                           std::size_t                     bytes,
+                           Test::bench::Measurement const& m,
+                           std::string_view                extra) {
+        fmt::print(R"({{"op":"{}","config":"{}","stream":"{}","frames":{},"bytes":{},)"
+                   R"("iterations":{},"ns_per_op":{:.2f},"mb_per_s":{:.2f},)"
+                   R"("frames_per_s":{:.0f}{}}})"
+                   "\n",
+                   op,
+                   name,
+                   stream,
+                   count,
+                   bytes,
+                   m.iterations,
+                   m.ns_per_op,
+                   Test::bench::mb_per_s(bytes, m),
+                   static_cast<double>(count) * 1e9 / m.ns_per_op,
+                   extra);
+    };
+
+    std::vector<std::byte> buffer{};
+    auto const             pack = runner.measure(fmt::format("pack/{}/clean", name), [&] {
+        buffer.clear();
+        for(auto const& message : messages) { Packager::pack(buffer, message); }
+        escape(buffer);
+        return buffer.size() == clean.size();
+    });
+    if(pack) { print("pack", "clean", clean.size(), *pack, {}); }
+
+    auto const unpack = runner.measure(fmt::format("unpack/{}/clean", name), [&] {
+        auto const result
+          = Packager::template unpack_all<Message>(clean, [](Message&& m) { escape(m); });
+        return result.decoded == count;
+    });
+    if(unpack) { print("unpack", "clean", clean.size(), *unpack, {}); }
+
+    auto const                      noisy = make_noisy(frames, noise);
+    typename Packager::UnpackResult result{};
+    auto const                      unpack_noisy
+      = runner.measure(fmt::format("unpack/{}/noisy", name), [&] {
+            result = Packager::template unpack_all<Message>(noisy.bytes,
+                                                            [](Message&& m) { escape(m); });
+            return true;
+        });
+    if(unpack_noisy) {
+        auto const recovery = analyze<Packager>(noisy, messages);
+        print("unpack",
+              "noisy",
+              noisy.bytes.size(),
+              *unpack_noisy,
+              fmt::format(R"(,"bit_error_rate":{},"truncation_rate":{},"garbage_rate":{},)"
+                          R"("corruptions":{},"decoded":{},"discarded":{},"frames_lost":{},)"
+                          R"("false_frames":{},"resync_bytes_mean":{:.2f},"resync_bytes_max":{})",
+                          noise.bitErrorRate,
+                          noise.truncationRate,
+                          noise.garbageRate,
+                          noisy.corruptions.size(),
+                          recovery.decoded,
+                          result.discarded,
+                          recovery.framesLost,
+                          recovery.falseFrames,
+                          recovery.resyncBytesMean,
+                          recovery.resyncBytesMax));
+    }
+}
+
+}   // namespace
+
+int main(int    argc,
+         char** argv) {
+    Test::bench::Arguments const arguments{argc, argv};
+    Test::bench::Runner          runner{arguments};
+
+    auto const messages = make_messages(arguments.get<std::size_t>("frames", 1000));
+    Noise const noise{.bitErrorRate   = arguments.get<double>("ber", 1e-5),
+                      .truncationRate = arguments.get<double>("truncation", 1e-3),
+                      .garbageRate    = arguments.get<double>("garbage", 1e-3),
+                      .seed           = arguments.get<std::uint64_t>("seed", 1)};
+
+    [&]<typename... Cs>(std::tuple<Cs...>*) {
+        (bench_config<Cs>(runner, messages, noise), ...);
+    }(static_cast<ConfigsList*>(nullptr));
+    bench_config<Configs::Compressed>(runner, messages, noise);
+
+    return runner.failed ? 1 : 0;
+}
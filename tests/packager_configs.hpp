@@ -0,0 +1,129 @@
+#pragma once
+
+#include <aglio/compression.hpp>
+#include <aglio/crc.hpp>
+#include <aglio/serializer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+
+namespace Test::packager {
+
+struct MyCrc {
+    using type = std::uint32_t;
+
+    static type calc(std::span<std::byte const> data) {
+        // A dummy CRC function for testing
+        type crc = 0;
+        for(auto b : data) { crc += static_cast<type>(b); }
+        return crc;
+    }
+};
+
+namespace Configs {
+
+    // Minimal (Size_t only, no CRC, no PackageStart)
+    struct Minimal {
+        using Size_t = std::uint32_t;
+    };
+
+    // PackageStart only (no CRC)
+    struct SimplePackageStart {
+        using Size_t                                = std::uint32_t;
+        static constexpr std::uint16_t PackageStart = 0xABCD;
+    };
+
+    // CRC only (UseHeaderCrc defaults to true when CRC present)
+    struct SimpleCrc {
+        using Crc    = MyCrc;
+        using Size_t = std::uint32_t;
+    };
+
+    // CRC with UseHeaderCrc explicitly disabled
+    struct CrcNoHeader {
+        using Crc                          = MyCrc;
+        using Size_t                       = std::uint32_t;
+        static constexpr bool UseHeaderCrc = false;
+    };
+
+    // PackageStart + CRC (implicit UseHeaderCrc=true)
+    struct Full {
+        using Crc                                   = MyCrc;
+        using Size_t                                = std::uint32_t;
+        static constexpr std::uint16_t PackageStart = 0xABCD;
+    };
+
+    // PackageStart + CRC with UseHeaderCrc=false
+    struct FullNoHeaderCrc {
+        using Crc                                   = MyCrc;
+        using Size_t                                = std::uint32_t;
+        static constexpr std::uint16_t PackageStart = 0xABCD;
+        static constexpr bool          UseHeaderCrc = false;
+    };
+
+    // PackageStart + built-in CRC-32
+    struct BuiltinCrc {
+        using Crc                                   = aglio::Crc32;
+        using Size_t                                = std::uint16_t;
+        static constexpr std::uint16_t PackageStart = 0xABCD;
+    };
+
+    // PackageStart + built-in CRC-32C over header and body
+    struct BuiltinCrcNoHeader {
+        using Crc                                   = aglio::Crc32c;
+        using Size_t                                = std::uint32_t;
+        static constexpr std::uint16_t PackageStart = 0xABCD;
+        static constexpr bool          UseHeaderCrc = false;
+    };
+
+    // Header, body and crc in network byte order
+    struct BigEndianFrames {
+        using Crc                                   = aglio::Crc32;
+        using Size_t                                = aglio::BigEndian<std::uint16_t>;
+        static constexpr std::uint16_t PackageStart = 0xABCD;
+    };
+
+    // Bodies of 16 bytes and more are compressed when that makes them smaller
+    struct Compressed {
+        using Crc                                           = aglio::Crc32c;
+        using Compression                                   = aglio::LzRle;
+        using Size_t                                        = std::uint32_t;
+        static constexpr std::uint16_t PackageStart         = 0xABCD;
+        static constexpr std::size_t   CompressionThreshold = 16;
+    };
+
+    // Frames of Compressed are only accepted up to 256 uncompressed bytes
+    struct CompressedSmallFrames : Compressed {
+        static constexpr std::uint32_t MaxSize = 256;
+    };
+
+    // Frames of any size, but only bodies up to 1 KiB are compressed
+    struct CompressedSmallBodies : Compressed {
+        static constexpr std::size_t MaxUncompressedSize = 1024;
+    };
+
+    // Same framing as Config, but the Crc only offers calc
+    template<typename Config>
+    struct CalcOnlyCrc : Config {
+        struct Crc {
+            using type = typename Config::Crc::type;
+
+            static type calc(std::span<std::byte const> data) { return Config::Crc::calc(data); }
+        };
+    };
+
+}   // namespace Configs
+
+using ConfigsList = std::tuple<Configs::Minimal,
+                               Configs::SimplePackageStart,
+                               Configs::SimpleCrc,
+                               Configs::CrcNoHeader,
+                               Configs::Full,
+                               Configs::FullNoHeaderCrc,
+                               Configs::BuiltinCrc,
+                               Configs::BuiltinCrcNoHeader,
+                               Configs::BigEndianFrames>;
+
+}   // namespace Test::packager
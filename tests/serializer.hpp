@@ -0,0 +1,895 @@
+#pragma once
+
+#include "cartesian_product.hpp"
+#include "types.hpp"
+
+#include <aglio/serialization_buffers.hpp>
+#include <aglio/serializer.hpp>
+
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+#if __has_include(<flat_map>)
+    #include <flat_map>
+    #include <flat_set>
+#endif
+
+template<>
+struct aglio::EnumMax<Types::Color> {
+    static constexpr Types::Color value = Types::Color::Blue;
+};
+
+namespace Test::serializer {
+
+using Serializer = aglio::Serializer<std::uint32_t>;
+
+static_assert(Serializer::fixed_size<std::uint16_t> == sizeof(std::uint16_t));
+static_assert(Serializer::fixed_size<std::array<int, 5>> == sizeof(std::uint32_t) + 5 * sizeof(int));
+static_assert(Serializer::fixed_size<Types::Enum> == sizeof(Types::Color) + sizeof(Types::Status));
+static_assert(Serializer::fixed_size<Types::Primitive, Types::Chrono>.has_value());
+static_assert(!Serializer::fixed_size<Types::Container>.has_value());
+static_assert(!Serializer::fixed_size<Types::Wrapper>.has_value());
+static_assert(aglio::Serializer<aglio::Varint<std::uint32_t>>::fixed_size<std::array<int, 5>>
+              == 1 + 5 * sizeof(int));
+
+using SizesList = std::tuple<std::uint16_t,
+                             std::uint32_t,
+                             aglio::Varint<std::uint32_t>,
+                             aglio::VarintIntegers<std::uint16_t>,
+                             aglio::VarintIntegers<aglio::Varint<std::uint32_t>>,
+                             aglio::LittleEndian<std::uint32_t>,
+                             aglio::BigEndian<std::uint32_t>,
+                             aglio::BigEndian<aglio::VarintIntegers<std::uint16_t>>,
+                             aglio::Compact<std::uint16_t>,
+                             aglio::Compact<aglio::VarintIntegers<aglio::Varint<std::uint32_t>>>,
+                             aglio::BitPacked<std::uint16_t>,
+                             aglio::Compact<aglio::BitPacked<std::uint32_t>>,
+                             aglio::Columnar<aglio::BitPacked<aglio::Varint<std::uint32_t>>>>;
+
+using TestCases = typename cartesian_product<Types::List, SizesList>::type;
+
+struct Vec3 {
+    float x{};
+    float y{};
+    float z{};
+
+#ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wfloat-equal"
+#endif
+    constexpr auto operator<=>(Vec3 const&) const = default;
+#ifdef __clang__
+    #pragma clang diagnostic pop
+#endif
+};
+
+struct Sample {
+    std::uint64_t timestamp{};
+    Vec3          position{};
+    Types::Color  color{};
+    std::uint8_t  quality{};
+    std::uint16_t id{};
+
+    constexpr auto operator<=>(Sample const&) const = default;
+};
+
+static_assert(aglio::detail::memcpyable<Vec3, std::uint32_t>);
+static_assert(aglio::detail::memcpyable<Sample, std::uint32_t>);
+static_assert(!aglio::detail::memcpyable<Sample, aglio::VarintIntegers<std::uint32_t>>);
+static_assert(!aglio::detail::memcpyable<Types::Primitive, std::uint32_t>);
+static_assert(!aglio::detail::memcpyable<Types::Container, std::uint32_t>);
+static_assert(!aglio::detail::memcpyable<Vec3, aglio::Compact<std::uint32_t>>);
+
+struct Health {
+    bool                powered{};
+    Types::Color        led{};
+    bool                charging{};
+    std::uint16_t       voltage{};
+    bool                overheated{};
+    Types::Status       status{};   // no EnumMax, written in full
+    std::array<bool, 2> faults{};
+
+    constexpr auto operator<=>(Health const&) const = default;
+};
+
+struct Status {
+    std::uint32_t                id{};
+    std::optional<std::uint16_t> error{};
+    bool                         online{true};
+    float                        temperature{};
+    std::string                  name{"node"};
+    std::vector<int>             samples{};
+    Vec3                         position{};
+    std::uint8_t                 retries{3};
+
+#ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wfloat-equal"
+#endif
+    constexpr auto operator<=>(Status const&) const = default;
+#ifdef __clang__
+    #pragma clang diagnostic pop
+#endif
+};
+
+struct Fallback {
+    int                a{};
+    std::optional<int> port{5};
+
+    constexpr auto operator<=>(Fallback const&) const = default;
+};
+
+template<typename Type,
+         typename Serializer>
+void test() {
+    std::vector<std::byte> buffer{};
+
+    Type const t_in = Types::createDefault<Type>();
+
+    aglio::DynamicSerializationView sebuff{buffer};
+    REQUIRE(Serializer::serialize(sebuff, t_in));
+    CHECK(Serializer::serialized_size(t_in) == sebuff.size());
+
+    aglio::DynamicDeserializationView debuff{buffer};
+    auto const                        t_out = Serializer::template deserialize<Type>(debuff);
+    REQUIRE(t_out.has_value());
+    CHECK(debuff.available() == 0);
+    CHECK(t_in == *t_out);
+}
+
+template<typename Type>
+void test_buffered_stream() {
+    Type const t_in = Types::createDefault<Type>();
+
+    std::vector<std::byte> expected{};
+    {
+        aglio::DynamicSerializationView sebuff{expected};
+        REQUIRE(Serializer::serialize(sebuff, t_in));
+    }
+
+    std::stringstream stream{};
+    {
+        // small block so that flushes and bypassing inserts happen
+        aglio::BufferedStreamSerializationView<std::stringstream, 16> sebuff{stream};
+        REQUIRE(Serializer::serialize(sebuff, t_in, t_in));
+        CHECK(sebuff.size() == 2 * expected.size());
+        REQUIRE(sebuff.flush());
+    }
+    CHECK(stream.str().size() == 2 * expected.size());
+
+    {
+        aglio::BufferedStreamDeserializationView<std::stringstream, 16> debuff{stream,
+                                                                              expected.size()};
+        CHECK(debuff.size() == expected.size());
+        auto const t_out = Serializer::template deserialize<Type>(debuff);
+        REQUIRE(t_out.has_value());
+        CHECK(t_in == *t_out);
+        CHECK(debuff.size() == 0);
+    }
+
+    // the known length kept the second copy in the stream
+    aglio::BufferedStreamDeserializationView debuff{stream};
+    auto const                               t_out = Serializer::template deserialize<Type>(debuff);
+    REQUIRE(t_out.has_value());
+    CHECK(t_in == *t_out);
+}
+}   // namespace Test::serializer
+
+TEST_CASE("Serializer memcpyable", "[memcpy]") {
+    using Test::serializer::Sample;
+    using Test::serializer::Serializer;
+    using Test::serializer::Vec3;
+
+    Sample const sample{
+      .timestamp = 123456789,
+      .position  = {.x = 1.0f, .y = 2.0f, .z = 3.0f},
+      .color     = Types::Color::Green,
+      .quality   = 7,
+      .id        = 4711
+    };
+
+    std::vector<std::byte>          packed{};
+    aglio::DynamicSerializationView packed_view{packed};
+    REQUIRE(Serializer::serialize(packed_view, sample));
+
+    std::vector<std::byte>          fields{};
+    aglio::DynamicSerializationView fields_view{fields};
+    REQUIRE(Serializer::serialize(fields_view,
+                                  sample.timestamp,
+                                  sample.position.x,
+                                  sample.position.y,
+                                  sample.position.z,
+                                  sample.color,
+                                  sample.quality,
+                                  sample.id));
+    CHECK(packed == fields);
+
+    std::vector<Sample> const       samples(100, sample);
+    std::array<Vec3, 3> const       positions{sample.position, Vec3{}, sample.position};
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView sebuff{buffer};
+    REQUIRE(Serializer::serialize(sebuff, samples, positions));
+    CHECK(buffer.size()
+          == 2 * sizeof(std::uint32_t) + sizeof(Sample) * samples.size() + sizeof(positions));
+
+    std::vector<Sample>               samples_out{};
+    std::array<Vec3, 3>               positions_out{};
+    aglio::DynamicDeserializationView debuff{buffer};
+    REQUIRE(Serializer::deserialize(debuff, samples_out, positions_out));
+    CHECK(samples == samples_out);
+    CHECK(positions == positions_out);
+}
+
+TEMPLATE_LIST_TEST_CASE("Serializer",
+                        "[cartesian]",
+                        Test::serializer::TestCases) {
+    using Type   = std::tuple_element_t<0, TestType>;
+    using Size_t = std::tuple_element_t<1, TestType>;
+
+    Test::serializer::test<Type, aglio::Serializer<Size_t>>();
+}
+
+TEST_CASE("Serializer varint", "[varint]") {
+    using Serializer = aglio::Serializer<aglio::Varint<std::uint32_t>>;
+
+    auto serialize = [](auto const&... vs) {
+        std::vector<std::byte>          buffer{};
+        aglio::DynamicSerializationView sebuff{buffer};
+        REQUIRE(Serializer::serialize(sebuff, vs...));
+        return buffer;
+    };
+
+    CHECK(serialize(std::string{}).size() == 1);
+    CHECK(serialize(std::string(127, 'a')).size() == 1 + 127);
+    CHECK(serialize(std::string(300, 'a')).size() == 2 + 300);
+    CHECK(serialize(std::variant<int, std::string>{1}).size() == 1 + sizeof(int));
+
+    for(std::uint32_t const size : {0U, 1U, 127U, 128U, 16383U, 16384U, 100000U}) {
+        std::vector<std::uint8_t> const v_in(size, 42);
+        auto                            buffer = serialize(v_in, v_in);
+
+        std::vector<std::uint8_t>         v_out{};
+        aglio::DynamicDeserializationView debuff{buffer};
+        REQUIRE(Serializer::deserialize(debuff, v_out));
+        CHECK(v_in == v_out);
+        REQUIRE(Serializer::deserialize(debuff, v_out));
+        CHECK(v_in == v_out);
+    }
+
+    auto deserialize = [](std::vector<std::byte> buffer) {
+        std::string                       s{};
+        aglio::DynamicDeserializationView debuff{buffer};
+        return aglio::Serializer<aglio::Varint<std::uint16_t>>::deserialize(debuff, s);
+    };
+
+    // truncated prefix
+    CHECK_FALSE(deserialize({std::byte{0x80}}));
+    // 2^16 does not fit into std::uint16_t
+    CHECK_FALSE(deserialize({std::byte{0x80}, std::byte{0x80}, std::byte{0x04}}));
+    CHECK_FALSE(deserialize({std::byte{0x80},
+                             std::byte{0x80},
+                             std::byte{0x04},
+                             std::byte{},
+                             std::byte{},
+                             std::byte{},
+                             std::byte{},
+                             std::byte{}}));
+    // longer than the buffer
+    CHECK_FALSE(deserialize({std::byte{0x05}, std::byte{'a'}}));
+    CHECK(deserialize({std::byte{0x01}, std::byte{'a'}}));
+}
+
+TEST_CASE("Serializer varint integers", "[varint]") {
+    using Serializer = aglio::Serializer<aglio::VarintIntegers<aglio::Varint<std::uint32_t>>>;
+
+    auto serialize = [](auto const&... vs) {
+        std::vector<std::byte>          buffer{};
+        aglio::DynamicSerializationView sebuff{buffer};
+        REQUIRE(Serializer::serialize(sebuff, vs...));
+        CHECK(Serializer::serialized_size(vs...) == buffer.size());
+        return buffer;
+    };
+
+    CHECK(serialize(std::int64_t{0}).size() == 1);
+    CHECK(serialize(std::int64_t{-1}).size() == 1);
+    CHECK(serialize(std::int64_t{63}).size() == 1);
+    CHECK(serialize(std::int64_t{64}).size() == 2);
+    CHECK(serialize(std::numeric_limits<std::int64_t>::min()).size() == 10);
+    CHECK(serialize(std::uint16_t{65535}).size() == 3);
+    CHECK(serialize(std::uint8_t{255}, true, 1.0f, Types::Color::Red).size() == 7);
+
+    std::vector<std::int64_t> v_in{};
+    for(std::int64_t i = -300; i != 300; ++i) { v_in.push_back(i); }
+    for(std::int64_t i = 0; i != 64; ++i) { v_in.push_back(i % 5); }
+    v_in.push_back(std::numeric_limits<std::int64_t>::min());
+    v_in.push_back(std::numeric_limits<std::int64_t>::max());
+
+    std::array<std::int16_t, 4> const a_in{-32768, -1, 0, 32767};
+
+    auto buffer = serialize(v_in, a_in);
+
+    std::vector<std::int64_t>         v_out{};
+    std::array<std::int16_t, 4>       a_out{};
+    aglio::DynamicDeserializationView debuff{buffer};
+    REQUIRE(Serializer::deserialize(debuff, v_out, a_out));
+    CHECK(debuff.available() == 0);
+    CHECK(v_in == v_out);
+    CHECK(a_in == a_out);
+
+    // 2^16 does not fit into std::uint16_t
+    std::vector<std::byte> overflow{std::byte{0x01},
+                                    std::byte{0x80},
+                                    std::byte{0x80},
+                                    std::byte{0x04}};
+    std::vector<std::uint16_t>        o_out{};
+    aglio::DynamicDeserializationView o_debuff{overflow};
+    CHECK_FALSE(Serializer::deserialize(o_debuff, o_out));
+}
+
+namespace Test::serializer {
+struct Blob {
+    std::uint32_t                 id{};
+    std::string_view              name{};
+    std::span<std::byte const>    payload{};
+};
+}   // namespace Test::serializer
+
+TEST_CASE("Serializer zero-copy", "[views]") {
+    using Test::serializer::Blob;
+    using Test::serializer::Serializer;
+
+    std::array<std::byte, 3> const    payload{std::byte{1}, std::byte{2}, std::byte{3}};
+    std::array<std::int32_t, 2> const samples{-1, 1};
+    std::string const                 name{"sensor"};
+
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView sebuff{buffer};
+    REQUIRE(Serializer::serialize(sebuff, Blob{.id = 7, .name = name, .payload = payload}));
+    REQUIRE(Serializer::serialize(sebuff, std::string{"abc"}));
+
+    Blob                              blob{};
+    std::string_view                  str{};
+    aglio::DynamicDeserializationView debuff{buffer};
+    REQUIRE(Serializer::deserialize(debuff, blob, str));
+    CHECK(blob.id == 7);
+    CHECK(blob.name == name);
+    CHECK(std::ranges::equal(blob.payload, payload));
+    CHECK(str == "abc");
+
+    auto const in_buffer = [&](auto const& view) {
+        auto const* p = reinterpret_cast<std::byte const*>(view.data());
+        return p >= buffer.data() && p < buffer.data() + buffer.size();
+    };
+    CHECK(in_buffer(blob.name));
+    CHECK(in_buffer(blob.payload));
+    CHECK(in_buffer(str));
+
+    // wider elements end up wherever the fields before them put them, they are written from a
+    // view and read back by copying
+    for(std::size_t length = 0; length != 8; ++length) {
+        std::vector<std::byte>          unaligned{};
+        aglio::DynamicSerializationView unaligned_sebuff{unaligned};
+        REQUIRE(Serializer::serialize(unaligned_sebuff,
+                                      std::string(length, 'x'),
+                                      std::span<std::int32_t const>{samples}));
+
+        std::string_view                  prefix{};
+        std::vector<std::int32_t>         samples_out{};
+        aglio::DynamicDeserializationView unaligned_debuff{unaligned};
+        REQUIRE(Serializer::deserialize(unaligned_debuff, prefix, samples_out));
+        CHECK(unaligned_debuff.available() == 0);
+        CHECK(prefix.size() == length);
+        CHECK(std::ranges::equal(samples_out, samples));
+    }
+}
+
+TEST_CASE("Serializer buffer growth", "[buffers]") {
+    using Test::serializer::Serializer;
+
+    auto const t_in = Types::createDefault<Types::Container>();
+
+    std::vector<std::byte> expected{};
+    {
+        aglio::DynamicSerializationView sebuff{expected};
+        REQUIRE(Serializer::serialize(sebuff, t_in));
+    }
+
+    std::vector<std::byte>                                             exact{};
+    aglio::DynamicSerializationView<decltype(exact), aglio::GrowExact> exact_view{exact};
+    REQUIRE(Serializer::serialize(exact_view, t_in));
+    CHECK(exact == expected);
+    CHECK(exact.capacity() == exact.size());
+
+    using UninitializedVector = std::vector<std::byte, aglio::default_init_allocator<std::byte>>;
+
+    UninitializedVector             uninitialized{};
+    aglio::DynamicSerializationView uninitialized_view{uninitialized, expected.size()};
+    CHECK(uninitialized.capacity() >= expected.size());
+    REQUIRE(Serializer::serialize(uninitialized_view, t_in));
+    CHECK(std::ranges::equal(uninitialized, expected));
+
+    std::string                     string{};
+    aglio::DynamicSerializationView string_view{string};
+    REQUIRE(Serializer::serialize(string_view, t_in));
+    CHECK(std::ranges::equal(std::as_bytes(std::span{string}), expected));
+
+    // a reused buffer is overwritten from the start and shrunk to what was written
+    std::vector<std::byte>          reused(expected.size() * 2, std::byte{0xFF});
+    aglio::DynamicSerializationView reused_view{reused};
+    REQUIRE(Serializer::serialize(reused_view, t_in));
+    reused_view.finalize();
+    CHECK(reused == expected);
+}
+
+TEMPLATE_LIST_TEST_CASE("Serializer buffered stream",
+                        "[buffers]",
+                        Types::List) {
+    Test::serializer::test_buffered_stream<TestType>();
+}
+
+TEST_CASE("Serializer buffered stream truncated", "[buffers]") {
+    using Test::serializer::Serializer;
+
+    std::vector<std::uint32_t> const values(100, 42);
+
+    std::stringstream stream{};
+    {
+        aglio::BufferedStreamSerializationView sebuff{stream};
+        REQUIRE(Serializer::serialize(sebuff, values));
+    }
+
+    std::vector<std::uint32_t>               out{};
+    aglio::BufferedStreamDeserializationView debuff{stream, stream.str().size() - 1};
+    CHECK_FALSE(Serializer::deserialize(debuff, out));
+}
+
+TEST_CASE("Serializer byte order", "[byte_order]") {
+    using Big    = aglio::Serializer<aglio::BigEndian<std::uint16_t>>;
+    using Little = aglio::Serializer<aglio::LittleEndian<std::uint16_t>>;
+
+    STATIC_REQUIRE(aglio::detail::memcpyable<std::uint8_t, aglio::BigEndian<std::uint16_t>>);
+    STATIC_REQUIRE(aglio::detail::memcpyable<std::uint32_t, aglio::BigEndian<std::uint16_t>>
+                   == (std::endian::native == std::endian::big));
+
+    std::vector<std::byte>          big{};
+    aglio::DynamicSerializationView big_view{big};
+    REQUIRE(Big::serialize(big_view, std::uint32_t{0x0102'0304}, 1.0f));
+    CHECK(big
+          == std::vector{std::byte{0x01},
+                         std::byte{0x02},
+                         std::byte{0x03},
+                         std::byte{0x04},
+                         std::byte{0x3F},
+                         std::byte{0x80},
+                         std::byte{0x00},
+                         std::byte{0x00}});
+
+    // odd length so that the vectorized swap has a tail
+    std::vector<std::uint16_t> values(1001);
+    std::iota(values.begin(), values.end(), std::uint16_t{0x0100});
+    std::vector<std::uint64_t> wide(37);
+    std::iota(wide.begin(), wide.end(), std::uint64_t{0x0102'0304'0506'0708});
+
+    std::vector<std::byte>          little{};
+    aglio::DynamicSerializationView little_view{little};
+    REQUIRE(Little::serialize(little_view, values, wide));
+
+    big.clear();
+    aglio::DynamicSerializationView values_view{big};
+    REQUIRE(Big::serialize(values_view, values, wide));
+    REQUIRE(big.size() == little.size());
+
+    // lengths are swapped as a whole, elements one by one
+    CHECK(big[0] == little[1]);
+    CHECK(big[1] == little[0]);
+    for(std::size_t i = 0; i != values.size(); ++i) {
+        CHECK(big[2 + 2 * i] == little[2 + 2 * i + 1]);
+        CHECK(big[2 + 2 * i + 1] == little[2 + 2 * i]);
+    }
+    auto const wide_offset = 2 + 2 * values.size() + 2;
+    for(std::size_t i = 0; i != wide.size(); ++i) {
+        for(std::size_t b = 0; b != 8; ++b) {
+            CHECK(big[wide_offset + 8 * i + b] == little[wide_offset + 8 * i + 7 - b]);
+        }
+    }
+
+    std::vector<std::uint16_t>        values_out{};
+    std::vector<std::uint64_t>        wide_out{};
+    aglio::DynamicDeserializationView debuff{big};
+    REQUIRE(Big::deserialize(debuff, values_out, wide_out));
+    CHECK(values_out == values);
+    CHECK(wide_out == wide);
+}
+
+TEST_CASE("Serializer pmr", "[pmr]") {
+    using Serializer = aglio::Serializer<std::uint16_t>;
+    using Strings    = std::pmr::vector<std::pmr::string>;
+    using Map        = std::pmr::map<std::pmr::string, std::pmr::vector<std::uint32_t>>;
+
+    Strings const strings{"a string that does not fit into the small buffer", "b"};
+    Map const     map{{"key long enough to need an allocation", {1, 2, 3}}, {"k", {}}};
+
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView view{buffer};
+    REQUIRE(Serializer::serialize(view, strings, map, std::optional<std::pmr::string>{"opt"}));
+
+    std::array<std::byte, 4096>         storage{};
+    std::pmr::monotonic_buffer_resource arena{storage.data(),
+                                              storage.size(),
+                                              std::pmr::null_memory_resource()};
+
+    Strings                          strings_out{};
+    Map                              map_out{};
+    std::optional<std::pmr::string>  opt_out{};
+    aglio::DynamicDeserializationView debuff{buffer};
+    aglio::PmrDeserializationView     pmr_view{debuff, &arena};
+
+    // every allocation has to come from the arena
+    auto* const previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    bool const  ok       = Serializer::deserialize(pmr_view, strings_out, map_out, opt_out);
+    std::pmr::set_default_resource(previous);
+
+    REQUIRE(ok);
+    CHECK(strings_out == strings);
+    CHECK(map_out == map);
+    REQUIRE(opt_out);
+    CHECK(*opt_out == "opt");
+    CHECK(strings_out.get_allocator().resource() == &arena);
+    CHECK(strings_out[0].get_allocator().resource() == &arena);
+    CHECK(map_out.begin()->first.get_allocator().resource() == &arena);
+    CHECK(opt_out->get_allocator().resource() == &arena);
+}
+
+TEST_CASE("Serializer associative input order", "[associative]") {
+    using Serializer = aglio::Serializer<std::uint16_t>;
+
+    // same encoding as a map, but unordered and with a duplicate key
+    std::vector<std::pair<int, std::string>> const pairs{{3, "three"},
+                                                         {1, "one"},
+                                                         {2, "two"},
+                                                         {1, "uno"}};
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView view{buffer};
+    REQUIRE(Serializer::serialize(view, pairs, pairs));
+
+    std::map<int, std::string>           map{{7, "stale"}};
+    std::unordered_map<int, std::string> hashed{};
+    aglio::DynamicDeserializationView    debuff{buffer};
+    REQUIRE(Serializer::deserialize(debuff, map, hashed));
+    CHECK(map == std::map<int, std::string>{{1, "one"}, {2, "two"}, {3, "three"}});
+    CHECK(hashed == std::unordered_map<int, std::string>{{1, "one"}, {2, "two"}, {3, "three"}});
+
+    std::vector<std::byte>          sorted{};
+    aglio::DynamicSerializationView sorted_view{sorted};
+    std::multiset<int> const        multi{1, 1, 2, 5, 5, 5};
+    REQUIRE(Serializer::serialize(sorted_view, multi));
+    std::multiset<int>                multi_out{};
+    aglio::DynamicDeserializationView sorted_debuff{sorted};
+    REQUIRE(Serializer::deserialize(sorted_debuff, multi_out));
+    CHECK(multi_out == multi);
+
+#if __has_include(<flat_map>)
+    std::flat_map<int, std::string>   flat{};
+    std::flat_set<int>                flat_set{};
+    aglio::DynamicDeserializationView flat_debuff{buffer};
+    REQUIRE(Serializer::deserialize(flat_debuff, flat));
+    CHECK(std::ranges::equal(flat, map));
+
+    aglio::DynamicDeserializationView flat_sorted{sorted};
+    REQUIRE(Serializer::deserialize(flat_sorted, flat_set));
+    CHECK(std::ranges::equal(flat_set, std::set<int>{1, 2, 5}));
+#endif
+}
+
+namespace Test::serializer {
+template<std::size_t... Is>
+auto wide_variant(std::index_sequence<Is...>) -> std::variant<std::array<std::uint8_t, Is>...>;
+
+using WideVariant = decltype(wide_variant(std::make_index_sequence<40>{}));
+}   // namespace Test::serializer
+
+TEST_CASE("Serializer variant dispatch", "[variant]") {
+    using Serializer = aglio::Serializer<std::uint16_t>;
+    using Test::serializer::WideVariant;
+
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView view{buffer};
+    for(std::size_t const i : {0UZ, 1UZ, 17UZ, 38UZ, 39UZ}) {
+        WideVariant v{};
+        [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            ((Is == i ? (v.emplace<Is>().fill(static_cast<std::uint8_t>(i)), 0) : 0), ...);
+        }(std::make_index_sequence<40>{});
+        REQUIRE(Serializer::serialize(view, v));
+    }
+
+    aglio::DynamicDeserializationView debuff{buffer};
+    for(std::size_t const i : {0UZ, 1UZ, 17UZ, 38UZ, 39UZ}) {
+        WideVariant v{};
+        REQUIRE(Serializer::deserialize(debuff, v));
+        CHECK(v.index() == i);
+        std::visit(
+          [&](auto const& a) {
+              CHECK(std::ranges::all_of(a, [&](std::uint8_t b) { return b == i; }));
+          },
+          v);
+    }
+    CHECK(debuff.available() == 0);
+
+    // index past the last alternative
+    std::vector<std::byte>            invalid{std::byte{40}};
+    aglio::DynamicDeserializationView invalid_debuff{invalid};
+    WideVariant                       v{};
+    CHECK_FALSE(Serializer::deserialize(invalid_debuff, v));
+}
+
+TEST_CASE("Serializer compact structs", "[compact]") {
+    using Compact = aglio::Serializer<aglio::Compact<std::uint16_t>>;
+    using Full    = aglio::Serializer<std::uint16_t>;
+    using Test::serializer::Status;
+    using Test::serializer::Vec3;
+
+    STATIC_REQUIRE(!Compact::fixed_size<Vec3>.has_value());
+    STATIC_REQUIRE(Compact::fixed_size<Types::Chrono>.has_value());
+
+    auto serialize = [](auto serializer, auto const& v) {
+        std::vector<std::byte>          buffer{};
+        aglio::DynamicSerializationView view{buffer};
+        REQUIRE(decltype(serializer)::serialize(view, v));
+        CHECK(decltype(serializer)::serialized_size(v) == buffer.size());
+        return buffer;
+    };
+
+    // one bitmap byte for Status and one for the nested Vec3
+    CHECK(serialize(Compact{}, Status{}).size() == 2);
+    CHECK(serialize(Compact{}, Status{}).size() < serialize(Full{}, Status{}).size());
+
+    Status status{};
+    status.error       = 17;
+    status.online      = false;
+    status.temperature = -0.0f;
+    status.position.y  = 1.5f;
+    auto const buffer  = serialize(Compact{}, status);
+    CHECK(buffer.size() == 2 + sizeof(std::uint16_t) + sizeof(float) + sizeof(float));
+
+    // members that are not in the buffer are reset to their defaults
+    Status out{.id = 9, .error = 1, .name = "other", .samples = {1}, .retries = 0};
+    aglio::DynamicDeserializationView debuff{buffer};
+    REQUIRE(Compact::deserialize(debuff, out));
+    CHECK(debuff.available() == 0);
+    CHECK(out == status);
+    CHECK(std::signbit(out.temperature));
+
+    auto round_trip = [&](Status const& in) {
+        auto const                        bytes = serialize(Compact{}, in);
+        Status                            result{};
+        aglio::DynamicDeserializationView view{bytes};
+        REQUIRE(Compact::deserialize(view, result));
+        CHECK(result == in);
+    };
+    round_trip(Status{.id = 1, .name = "", .samples = {1, 2, 3}, .retries = 0});
+    round_trip(Status{.error = 0, .online = true, .temperature = 20.5f});
+
+    // an empty optional stays empty even when the default is engaged
+    for(auto const& in : {Test::serializer::Fallback{.port = std::nullopt},
+                          Test::serializer::Fallback{},
+                          Test::serializer::Fallback{.a = 1, .port = 7}})
+    {
+        auto const                        bytes = serialize(Compact{}, in);
+        Test::serializer::Fallback        result{};
+        aglio::DynamicDeserializationView view{bytes};
+        REQUIRE(Compact::deserialize(view, result));
+        CHECK(result == in);
+    }
+
+    // bits past the last member are rejected
+    std::vector<std::byte>            invalid{std::byte{0x80}, std::byte{0x00}};
+    aglio::DynamicDeserializationView invalid_debuff{invalid};
+    CHECK_FALSE(Compact::deserialize(invalid_debuff, out));
+}
+
+TEST_CASE("Serializer bit packing", "[bit_packed]") {
+    using Packed = aglio::Serializer<aglio::BitPacked<std::uint16_t>>;
+    using Test::serializer::Health;
+
+    STATIC_REQUIRE(aglio::detail::packed_width<Types::Color, aglio::BitPacked<std::uint16_t>>()
+                   == 2);
+    STATIC_REQUIRE(aglio::detail::packed_width<Types::Status, aglio::BitPacked<std::uint16_t>>()
+                   == 0);
+    // powered, led, charging and overheated share one byte, faults is a range of its own
+    STATIC_REQUIRE(Packed::fixed_size<Health> == 1 + 2 + sizeof(Types::Status) + 2 + 2);
+    STATIC_REQUIRE(aglio::Serializer<std::uint16_t>::fixed_size<Health>
+                   == 4 + 2 + sizeof(Types::Status) + 2 + 2);
+
+    Health const health{.powered    = true,
+                        .led        = Types::Color::Green,
+                        .charging   = false,
+                        .voltage    = 3300,
+                        .overheated = true,
+                        .status     = Types::Inactive,
+                        .faults     = {true, false}};
+
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView view{buffer};
+    REQUIRE(Packed::serialize(view, health));
+    REQUIRE(buffer.size() == *Packed::fixed_size<Health>);
+    // powered | led << 1 | charging << 3 | overheated << 4
+    CHECK(buffer[0] == std::byte{0b1'0'10'1});
+
+    Health                            out{};
+    aglio::DynamicDeserializationView debuff{buffer};
+    REQUIRE(Packed::deserialize(debuff, out));
+    CHECK(out == health);
+
+    // values past EnumMax can neither be written nor read
+    Health                          invalid = health;
+    std::vector<std::byte>          invalid_buffer{};
+    aglio::DynamicSerializationView invalid_view{invalid_buffer};
+    invalid.led = static_cast<Types::Color>(4);
+    CHECK_FALSE(Packed::serialize(invalid_view, invalid));
+    CHECK_FALSE(Packed::serialized_size(std::vector<Health>{invalid}).has_value());
+
+    buffer[0] = std::byte{0b1'0'0'00'0};
+    aglio::DynamicDeserializationView unused_bits{buffer};
+    CHECK_FALSE(Packed::deserialize(unused_bits, out));
+}
+
+TEST_CASE("Serializer bit vectors", "[bit_packed]") {
+    using Packed = aglio::Serializer<aglio::BitPacked<aglio::Varint<std::uint32_t>>>;
+
+    for(std::size_t const size : {0UZ, 1UZ, 8UZ, 63UZ, 64UZ, 65UZ, 4095UZ, 4096UZ, 5000UZ}) {
+        std::vector<bool> bits(size);
+        for(std::size_t i = 0; i != size; ++i) { bits[i] = (i * 7 + i / 3) % 5 < 2; }
+
+        std::vector<std::byte>          buffer{};
+        aglio::DynamicSerializationView view{buffer};
+        REQUIRE(Packed::serialize(view, bits));
+        CHECK(buffer.size() == aglio::detail::varint_size(size) + (size + 7) / 8);
+
+        std::vector<bool>                 out(3, true);
+        aglio::DynamicDeserializationView debuff{buffer};
+        REQUIRE(Packed::deserialize(debuff, out));
+        CHECK(out == bits);
+    }
+
+    std::bitset<70> flags{};
+    flags.set(0).set(9).set(64).set(69);
+    STATIC_REQUIRE(Packed::fixed_size<std::bitset<70>> == 9);
+
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView view{buffer};
+    REQUIRE(Packed::serialize(view, flags));
+    REQUIRE(buffer.size() == 9);
+    CHECK(buffer[0] == std::byte{0x01});
+    CHECK(buffer[1] == std::byte{0x02});
+    CHECK(buffer[8] == std::byte{0x21});
+
+    std::bitset<70>                   out{};
+    aglio::DynamicDeserializationView debuff{buffer};
+    REQUIRE(Packed::deserialize(debuff, out));
+    CHECK(out == flags);
+
+    // unused bits of the last byte
+    buffer[8] |= std::byte{0x40};
+    aglio::DynamicDeserializationView invalid{buffer};
+    CHECK_FALSE(Packed::deserialize(invalid, out));
+}
+
+TEST_CASE("Serializer columnar", "[columnar]") {
+    using Columnar = aglio::Serializer<aglio::Columnar<std::uint32_t>>;
+    using Rows     = aglio::Serializer<std::uint32_t>;
+    using Test::serializer::Health;
+    using Test::serializer::Sample;
+    using Test::serializer::Status;
+
+    std::vector<Sample> samples(300);
+    for(std::size_t i = 0; i != samples.size(); ++i) {
+        samples[i] = Sample{.timestamp = 1000 + i,
+                            .position  = {static_cast<float>(i), 0.5f, -1.0f},
+                            .color     = static_cast<Types::Color>(i % 3),
+                            .quality   = static_cast<std::uint8_t>(i),
+                            .id        = static_cast<std::uint16_t>(i * 3)};
+    }
+
+    std::vector<std::byte>          buffer{};
+    aglio::DynamicSerializationView view{buffer};
+    REQUIRE(Columnar::serialize(view, samples, std::uint32_t{0xC0FFEE}));
+    CHECK(Columnar::serialized_size(samples, std::uint32_t{0xC0FFEE}) == buffer.size());
+    CHECK(buffer.size() == Rows::serialized_size(samples, std::uint32_t{0xC0FFEE}));
+
+    // the timestamps follow the size as one block
+    std::vector<std::uint64_t> timestamps(samples.size());
+    std::memcpy(timestamps.data(),
+                std::next(buffer.data(), sizeof(std::uint32_t)),
+                timestamps.size() * sizeof(std::uint64_t));
+    CHECK(timestamps.front() == 1000);
+    CHECK(timestamps.back() == 1299);
+
+    std::vector<Sample>               out{};
+    std::uint32_t                     trailer{};
+    aglio::DynamicDeserializationView debuff{buffer};
+    REQUIRE(Columnar::deserialize(debuff, out, trailer));
+    CHECK(debuff.available() == 0);
+    CHECK(out == samples);
+    CHECK(trailer == 0xC0FFEE);
+
+    // single columns, the rest is skipped
+    std::vector<std::uint16_t>        ids{};
+    aglio::DynamicDeserializationView id_debuff{buffer};
+    REQUIRE(Columnar::deserialize_column<std::vector<Sample>, 4>(id_debuff, ids));
+    REQUIRE(ids.size() == samples.size());
+    CHECK(ids[299] == 897);
+    REQUIRE(Columnar::deserialize(id_debuff, trailer));
+    CHECK(trailer == 0xC0FFEE);
+
+    std::stringstream stream{};
+    stream.write(reinterpret_cast<char const*>(buffer.data()),
+                 static_cast<std::streamsize>(buffer.size()));
+    std::list<Types::Color>                             colors{};
+    aglio::StreamDeserializationView<std::stringstream> stream_debuff{stream};
+    REQUIRE(Columnar::deserialize_column<std::vector<Sample>, 2>(stream_debuff, colors));
+    CHECK(*std::next(colors.begin(), 5) == Types::Color::Green);
+    REQUIRE(Columnar::deserialize(stream_debuff, trailer));
+    CHECK(trailer == 0xC0FFEE);
+
+    // variable sized columns carry their length
+    std::list<Status> statuses{Status{.id = 1, .error = 4, .samples = {1, 2}},
+                               Status{.id = 2, .name = "second"},
+                               Status{.id = 3, .samples = {3}}};
+    std::vector<std::byte>          status_buffer{};
+    aglio::DynamicSerializationView status_view{status_buffer};
+    REQUIRE(Columnar::serialize(status_view, statuses));
+    CHECK(status_buffer.size()
+          == Rows::serialized_size(statuses).value() + 3 * sizeof(std::uint32_t));
+
+    std::list<Status>                 statuses_out{};
+    aglio::DynamicDeserializationView status_debuff{status_buffer};
+    REQUIRE(Columnar::deserialize(status_debuff, statuses_out));
+    CHECK(statuses_out == statuses);
+
+    std::vector<std::vector<int>>     samples_column{};
+    aglio::DynamicDeserializationView column_debuff{status_buffer};
+    REQUIRE(Columnar::deserialize_column<std::list<Status>, 5>(column_debuff, samples_column));
+    CHECK(samples_column == std::vector<std::vector<int>>{{1, 2}, {}, {3}});
+    CHECK(column_debuff.available() == 0);
+
+    // a length that does not match its column
+    status_buffer[sizeof(std::uint32_t) + 3 * sizeof(std::uint32_t)] = std::byte{0xFF};
+    aglio::DynamicDeserializationView invalid{status_buffer};
+    CHECK_FALSE(Columnar::deserialize(invalid, statuses_out));
+
+    // bool columns become bit fields with BitPacked
+    using Packed = aglio::Serializer<aglio::Columnar<aglio::BitPacked<std::uint16_t>>>;
+    std::array<Health, 10> health{};
+    for(std::size_t i = 0; i != health.size(); ++i) {
+        health[i].powered = i % 2 == 0;
+        health[i].led     = static_cast<Types::Color>(i % 3);
+        health[i].voltage = static_cast<std::uint16_t>(3000 + i);
+        health[i].faults  = {i == 3, i == 7};
+    }
+    // three bool columns of two bytes, the enum, voltage, status and faults columns in full
+    STATIC_REQUIRE(Packed::fixed_size<std::array<Health, 10>>
+                   == 2 + 3 * 2 + 10 * (1 + 2 + sizeof(Types::Status) + 2 + 2));
+
+    std::vector<std::byte>          health_buffer{};
+    aglio::DynamicSerializationView health_view{health_buffer};
+    REQUIRE(Packed::serialize(health_view, health));
+    CHECK(health_buffer.size() == *Packed::fixed_size<std::array<Health, 10>>);
+
+    std::array<Health, 10>            health_out{};
+    aglio::DynamicDeserializationView health_debuff{health_buffer};
+    REQUIRE(Packed::deserialize(health_debuff, health_out));
+    CHECK(health_out == health);
+
+    std::vector<bool>                 powered{};
+    aglio::DynamicDeserializationView powered_debuff{health_buffer};
+    REQUIRE(Packed::deserialize_column<std::array<Health, 10>, 0>(powered_debuff, powered));
+    CHECK(powered == std::vector{true, false, true, false, true, false, true, false, true, false});
+}
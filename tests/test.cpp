@@ -22,7 +22,12 @@ Stream& operator<<(Stream&  os,
     #pragma clang diagnostic pop
 #endif
 //
+#include "compression.hpp"
+#include "crc.hpp"
+#include "delta.hpp"
 #include "fmt.hpp"
 #include "format.hpp"
+#include "log.hpp"
 #include "ostream.hpp"
 #include "packager.hpp"
+#include "serializer.hpp"